@@ -0,0 +1,273 @@
+/**
+ * @file
+ * Benchmarks sudoku solver.
+ */
+
+/***********************************************************************************
+* Author: Laurent Farhi                                                            *
+* Name: bench.c                                                                    *
+* Language: C                                                                      *
+* Copyright (C) 2009, All rights reserved.                                         *
+*                                                                                  *
+* LICENSE:                                                                         *
+* This program is free software; you can redistribute it and/or modify             *
+* it under the terms of the GNU General Public License as published by             *
+* the Free Software Foundation; either version 2 of the License, or                *
+* (at your option) any later version.                                              *
+*                                                                                  *
+* This program is distributed in the hope that it will be useful,                  *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of                   *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                    *
+* GNU General Public License for more details.                                     *
+*                                                                                  *
+* You should have received a copy of the GNU General Public License                *
+* along with this program; if not, write to the Free Software                      *
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA       *
+***********************************************************************************/
+
+#define _XOPEN_SOURCE
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "solve.h"
+#include "grid_io.h"
+
+/// Compares two latencies, for qsort().
+static int
+latency_compare (const void *a, const void *b)
+{
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+
+  return (x > y) - (x < y);
+}
+
+/// Returns the current time.
+/// @return Time in seconds, from a monotonic clock
+static double
+now (void)
+{
+  struct timespec t;
+
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/// Benchmarks a method on a set of grids and writes one line of results.
+/// @param[in] grids Grids to be solved
+/// @param[in] nbGrids Number of grids
+/// @param[in] method Method selected for solving the grids
+/// @param[in] find \c FIRST to find the first solution or \c ALL to find all solutions
+/// @param[in] warmup Number of resolutions of each grid before measurement
+/// @param[in] repetitions Number of measured resolutions of each grid
+/// @param[in] schedule Scheduling of the rules of the elimination method, 0 for the fixed order
+/// @param[in] cacheCapacity Number of results kept in a cache of results, 0 for none
+static void
+bench (int grids[][GRID_SIZE][GRID_SIZE], int nbGrids, method method, findSolutions find, int warmup,
+       int repetitions, const sudoku_schedule * schedule, int cacheCapacity)
+{
+  sudoku_context *const ctx = sudoku_context_create ();
+  sudoku_cache *const cache = cacheCapacity ? sudoku_cache_create (cacheCapacity) : 0;
+  double *latency = malloc ((size_t) nbGrids * repetitions * sizeof (*latency));
+
+  if (!latency)
+  {
+    fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+
+  sudoku_context_schedule_set (ctx, schedule);
+  sudoku_context_cache_set (ctx, cache);
+
+  for (int r = 0; r < warmup; r++)
+    for (int i = 0; i < nbGrids; i++)
+      sudoku_solve_ctx (ctx, grids[i], method, find, 0);
+
+  long hypotheses = 0;
+  int solved = 0;
+  double total = 0;
+
+  for (int r = 0; r < repetitions; r++)
+    for (int i = 0; i < nbGrids; i++)
+    {
+      sudoku_result result;
+      double start = now ();
+
+      sudoku_solve_ctx (ctx, grids[i], method, find, &result);
+      total += latency[r * nbGrids + i] = now () - start;
+      if (r == 0)
+      {
+        hypotheses += result.nbHypotheses;
+        solved += result.method != NONE;
+      }
+    }
+
+  int n = nbGrids * repetitions;
+
+  qsort (latency, n, sizeof (*latency), latency_compare);
+
+  // Percentiles by nearest rank.
+  printf ("%i,%s,%i,%i,%i,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f\n", SUDOKU_SIZE,
+          method == EXACT_COVER ? "EXACT_COVER" : method == BACKTRACKING ? "BACKTRACKING" : method ==
+          AUTO ? "AUTO" : "ELIMINATION", nbGrids,
+          solved, repetitions, n / total, latency[(n * 50 + 99) / 100 - 1] * 1e6,
+          latency[(n * 90 + 99) / 100 - 1] * 1e6, latency[(n * 99 + 99) / 100 - 1] * 1e6, latency[n - 1] * 1e6,
+          (double) hypotheses / nbGrids);
+  fflush (stdout);
+
+  free (latency);
+  sudoku_context_destroy (ctx);
+  sudoku_cache_destroy (cache);
+}
+
+/// Well, that's the entry point.
+int
+main (int argc, char *argv[])
+{
+  sudoku_init ();
+
+  findSolutions find = ALL;
+  int warmup = 1;
+  int repetitions = 5;
+  int generate = 100;
+  unsigned long seed = 1;
+  int header = 1;
+  sudoku_schedule schedule = { 0, 0, 0 };
+  int tiered = 0;
+  int cacheCapacity = 0;
+  method methods[4] = { ELIMINATION, BACKTRACKING, EXACT_COVER, AUTO };
+  int nbMethods = 0;
+
+  // Command-line options
+  const char options[] = "hfHLBEAw:n:G:s:t:C:";
+
+  opterr = 1;
+  for (int letter = 0; (letter = getopt (argc, argv, options)) >= 0;)
+  {
+    char *endptr = 0;
+
+    if (letter == '?')
+    {
+      printf ("Type '%s -h' for help.\n", argv[0]);
+      exit (-1);
+    }
+    else if (letter == 'h')
+    {
+      printf ("Usage:\n  %s [-fHLBEA] [-w n] [-n n] [-G n] [-s seed] [-t n] [-C n] [file]\n", argv[0]);
+      printf ("\nSolves each grid of file ('-' for the standard input), one grid per line, or generated puzzles,\n"
+              "and writes one line of comma separated values per method:\n"
+              "  size, method, grids, grids solved, repetitions, grids per second,\n"
+              "  p50, p90, p99 and max latencies (microseconds), hypotheses per grid.\n");
+      printf ("\nOptions:\n");
+      printf ("   -f\tSearch for the first solution only rather than all of them\n");
+      printf ("   -L\tBenchmark elimination method (all methods if none of -L, -B, -E or -A is given)\n");
+      printf ("   -B\tBenchmark backtracking method\n");
+      printf ("   -E\tBenchmark exact cover search method\n");
+      printf ("   -A\tBenchmark the race of elimination and backtracking methods\n");
+      printf ("   -w n\tNumber of unmeasured resolutions of each grid before measurement (default 1)\n");
+      printf ("   -n n\tNumber of measured resolutions of each grid (default 5)\n");
+      printf ("   -G n\tNumber of puzzles to generate if no file is given (default 100)\n");
+      printf ("   -s seed\tSeed of the generation (default 1)\n");
+      printf ("   -t n\tApply logical rules by increasing cost, preferring hypotheses to subsets larger than n\n"
+              "\t(never if n is 0) (elimination method)\n");
+      printf ("   -C n\tSolve through a cache of the results of up to n grids (none if n is 0)\n");
+      printf ("   -H\tDo not write the header line\n");
+      exit (0);
+    }
+    else if (letter == 'f')
+      find = FIRST;
+    else if (letter == 'H')
+      header = 0;
+    else if (letter == 'L' || letter == 'B' || letter == 'E' || letter == 'A')
+    {
+      if (nbMethods < sizeof (methods) / sizeof (*methods))
+        methods[nbMethods++] =
+          letter == 'L' ? ELIMINATION : letter == 'B' ? BACKTRACKING : letter == 'E' ? EXACT_COVER : AUTO;
+    }
+    else
+    {
+      long value = strtol (optarg, &endptr, 10);
+
+      if (value < (letter == 'w' || letter == 's' || letter == 't' || letter == 'C' ? 0 : 1) || *endptr)
+      {
+        fprintf (stderr, "Invalid option argument for option -%c: positive number expected.\n", letter);
+        exit (-1);
+      }
+      else if (letter == 'w')
+        warmup = value;
+      else if (letter == 'n')
+        repetitions = value;
+      else if (letter == 'G')
+        generate = value;
+      else if (letter == 's')
+        seed = value;
+      else if (letter == 't')
+      {
+        schedule.hypothesisDepth = value;
+        tiered = 1;
+      }
+      else if (letter == 'C')
+        cacheCapacity = value;
+    }
+  }
+  if (nbMethods == 0)
+    nbMethods = sizeof (methods) / sizeof (*methods);
+
+  int (*grids)[GRID_SIZE][GRID_SIZE] = 0;
+  int nbGrids = 0;
+
+  if (argc > optind)
+  {
+    grid_reader *input = grid_reader_open (argv[optind], 0);
+
+    if (!input)
+    {
+      perror (argv[optind]);
+      exit (-1);
+    }
+
+    for (int allocated = 0, n = 1; n; nbGrids += n)
+    {
+      if (nbGrids == allocated && !(grids = realloc (grids, (allocated = 2 * allocated + 64) * sizeof (*grids))))
+      {
+        fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+        exit (-1);
+      }
+      n = grid_reader_read (input, grids + nbGrids, allocated - nbGrids);
+    }
+    grid_reader_close (input);
+  }
+  else
+  {
+    sudoku_puzzle *puzzles = malloc (generate * sizeof (*puzzles));
+
+    if (!puzzles || !(grids = malloc (generate * sizeof (*grids))))
+    {
+      fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+      exit (-1);
+    }
+    nbGrids = sudoku_generate_batch (puzzles, generate, seed, 0, 0);
+    for (int i = 0; i < nbGrids; i++)
+      memcpy (grids[i], puzzles[i].grid, sizeof (*grids));
+    free (puzzles);
+  }
+
+  if (nbGrids == 0)
+  {
+    fprintf (stderr, "No grid to solve.\n");
+    exit (-1);
+  }
+
+  if (header)
+    printf ("size,method,grids,solved,repetitions,grids_per_s,p50_us,p90_us,p99_us,max_us,hypotheses_per_grid\n");
+  for (int m = 0; m < nbMethods; m++)
+    bench (grids, nbGrids, methods[m], find, warmup, repetitions, tiered ? &schedule : 0, cacheCapacity);
+
+  free (grids);
+  return 0;
+}
@@ -0,0 +1,545 @@
+/**
+ * @file
+ * Bulk reader and writer of sudoku grids.
+ */
+
+/***********************************************************************************
+* Author: Laurent Farhi                                                            *
+* Name: grid_io.c                                                                  *
+* Language: C                                                                      *
+* Copyright (C) 2009, All rights reserved.                                         *
+*                                                                                  *
+* LICENSE:                                                                         *
+* This program is free software; you can redistribute it and/or modify             *
+* it under the terms of the GNU General Public License as published by             *
+* the Free Software Foundation; either version 2 of the License, or                *
+* (at your option) any later version.                                              *
+*                                                                                  *
+* This program is distributed in the hope that it will be useful,                  *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of                   *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                    *
+* GNU General Public License for more details.                                     *
+*                                                                                  *
+* You should have received a copy of the GNU General Public License                *
+* along with this program; if not, write to the Free Software                      *
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA       *
+***********************************************************************************/
+
+#define _XOPEN_SOURCE
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "solve.h"
+#include "grid_io.h"
+
+/// Size of the first chunk read from inputs which are not mapped in memory.
+#define GRID_READER_CHUNK (1 << 16)
+
+/// Magic string of binary files.
+static const char GRID_IO_MAGIC[4] = "SDKB";
+
+/// Version of the format of binary files.
+#define GRID_IO_VERSION 1
+
+/// Size of the fields following the grids in a result record.
+#define GRID_IO_RESULT_FIELDS 9
+
+/// Definition of a reader of grids.
+///
+/// The text available, from pos to end, is either the whole mapped file or a window of the buffer.
+/// Lines are split by memchr(), which searches several bytes at a time.
+struct grid_reader
+{
+  int fd;                       ///< File descriptor of the input
+  char *map;                    ///< Contents of the input if mapped in memory, or null
+  size_t mapSize;               ///< Size of the mapping
+  char *buffer;                 ///< Buffer of the input if not mapped, or null
+  size_t bufferSize;            ///< Size of the buffer
+  const char *pos;              ///< First character not read yet
+  const char *end;              ///< End of the text available
+  int eof;                      ///< 1 if the end of the input is the end of the text available
+  long line;                    ///< Number of lines (or records) read
+  long nbIncomplete;            ///< Number of incomplete lines read
+  grid_reader_error_handler handler;    ///< Function called on each incomplete line, or null
+  grid_format format;           ///< Format of the input
+  size_t recordSize;            ///< Size of a record of binary input
+  long nbRecords;               ///< Number of records of binary input, -1 if unknown
+};
+
+/// Value of each character, 0 for an empty cell, -1 for a character to be ignored.
+static signed char gridCodes[256];
+
+/// Initialization of gridCodes.
+static pthread_once_t gridCodesOnce = PTHREAD_ONCE_INIT;
+
+/// Initializes gridCodes, with the same conventions as the command line: case is ignored, '.' stands for an empty cell.
+static void
+grid_codes_init (void)
+{
+  memset (gridCodes, -1, sizeof (gridCodes));
+  gridCodes[(unsigned char) toupper (sudoku_grid_referential.empty_code)] =
+    gridCodes[(unsigned char) tolower (sudoku_grid_referential.empty_code)] = 0;
+  for (int v = 0; v < GRID_SIZE; v++)
+    gridCodes[(unsigned char) toupper (sudoku_grid_referential.value_name[v])] =
+      gridCodes[(unsigned char) tolower (sudoku_grid_referential.value_name[v])] = v + 1;
+  gridCodes['.'] = 0;
+}
+
+int
+grid_parse (const char *text, size_t length, int g[GRID_SIZE][GRID_SIZE])
+{
+  int *const cells = &g[0][0];
+  int i = 0;
+
+  pthread_once (&gridCodesOnce, grid_codes_init);
+  for (const char *c = text; c < text + length && i < GRID_SIZE * GRID_SIZE; c++)
+  {
+    int code = gridCodes[(unsigned char) *c];
+
+    if (code >= 0)
+      cells[i++] = code;
+  }
+  return i;
+}
+
+/// Makes characters available from the first one not read yet, reading more of the input if needed.
+/// @param [in,out] r Reader
+/// @param [in] size Number of characters needed
+/// @return 1 if size characters are available, 0 if the input ends before
+static int
+grid_reader_fill (grid_reader * r, size_t size)
+{
+  while ((size_t) (r->end - r->pos) < size && !r->eof)
+  {
+    // Keep the characters not read yet at the front of the buffer, and read more.
+    size_t left = r->end - r->pos;
+
+    memmove (r->buffer, r->pos, left);
+    if (size > r->bufferSize || left == r->bufferSize)
+    {
+      while (r->bufferSize < size || r->bufferSize == left)
+        r->bufferSize *= 2;
+      if (!(r->buffer = realloc (r->buffer, r->bufferSize)))
+      {
+        fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+        exit (-1);
+      }
+    }
+
+    ssize_t n;
+
+    while ((n = read (r->fd, r->buffer + left, r->bufferSize - left)) < 0 && errno == EINTR)
+      /* nothing */ ;
+    if (n < 0)
+      perror ("read");
+    if (n <= 0)
+      r->eof = 1;
+    r->pos = r->buffer;
+    r->end = r->buffer + left + (n > 0 ? n : 0);
+  }
+  return (size_t) (r->end - r->pos) >= size;
+}
+
+/// Reads a little-endian integer.
+/// @param [in] bytes Bytes of the integer
+/// @param [in] size Number of bytes
+/// @return Integer
+static uint64_t
+grid_io_get (const unsigned char *bytes, int size)
+{
+  uint64_t v = 0;
+
+  for (int i = size; i > 0; i--)
+    v = (v << 8) | bytes[i - 1];
+  return v;
+}
+
+/// Writes a little-endian integer.
+/// @param [out] bytes Bytes of the integer
+/// @param [in] size Number of bytes
+/// @param [in] v Integer
+static void
+grid_io_put (unsigned char *bytes, int size, uint64_t v)
+{
+  for (int i = 0; i < size; i++, v >>= 8)
+    bytes[i] = v & 0xff;
+}
+
+/// Packs a grid.
+/// @param [in] cells Cells of the grid, row by row
+/// @param [out] bytes Packed grid, GRID_IO_GRID_SIZE bytes
+static void
+grid_io_pack (const int *cells, unsigned char *bytes)
+{
+  unsigned int bits = 0;
+  int nbBits = 0;
+
+  for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+  {
+    bits |= (cells[i] < 0 || cells[i] > GRID_SIZE ? 0 : (unsigned int) cells[i]) << nbBits;
+    for (nbBits += GRID_IO_CELL_BITS; nbBits >= 8; nbBits -= 8, bits >>= 8)
+      *bytes++ = bits & 0xff;
+  }
+  if (nbBits)
+    *bytes = bits & 0xff;
+}
+
+/// Unpacks a grid.
+/// @param [in] bytes Packed grid, GRID_IO_GRID_SIZE bytes
+/// @param [out] g Grid
+/// @return The number of cells before the first one holding a code above GRID_SIZE, GRID_SIZE * GRID_SIZE if none.
+static int
+grid_io_unpack (const unsigned char *bytes, int g[GRID_SIZE][GRID_SIZE])
+{
+  int nbValid = GRID_SIZE * GRID_SIZE;
+
+  int *const cells = &g[0][0];
+  unsigned int bits = 0;
+  int nbBits = 0;
+
+  for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+  {
+    for (; nbBits < GRID_IO_CELL_BITS; nbBits += 8)
+      bits |= (unsigned int) *bytes++ << nbBits;
+    cells[i] = bits & ((1U << GRID_IO_CELL_BITS) - 1);
+    if (cells[i] > GRID_SIZE && i < nbValid)
+      nbValid = i;
+    bits >>= GRID_IO_CELL_BITS;
+    nbBits -= GRID_IO_CELL_BITS;
+  }
+  return nbValid;
+}
+
+grid_reader *
+grid_reader_open (const char *path, grid_reader_error_handler handler)
+{
+  int fd = strcmp (path, "-") ? open (path, O_RDONLY) : STDIN_FILENO;
+
+  if (fd < 0)
+    return 0;
+
+  grid_reader *const r = calloc (1, sizeof (*r));
+
+  if (!r)
+  {
+    fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+  r->fd = fd;
+  r->handler = handler;
+  r->nbRecords = -1;
+
+  struct stat st;
+
+  if (fstat (fd, &st) == 0 && S_ISREG (st.st_mode) && st.st_size > 0
+      && (r->map = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) != MAP_FAILED)
+  {
+    madvise (r->map, st.st_size, MADV_SEQUENTIAL);
+    r->mapSize = st.st_size;
+    r->pos = r->map;
+    r->end = r->map + r->mapSize;
+    r->eof = 1;
+  }
+  else
+  {
+    r->map = 0;
+    if (!(r->buffer = malloc (r->bufferSize = GRID_READER_CHUNK)))
+    {
+      fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+      exit (-1);
+    }
+    r->pos = r->end = r->buffer;
+  }
+
+  // Binary header
+  if (grid_reader_fill (r, GRID_IO_HEADER_SIZE) && !memcmp (r->pos, GRID_IO_MAGIC, sizeof (GRID_IO_MAGIC)))
+  {
+    const unsigned char *const header = (const unsigned char *) r->pos;
+
+    if (header[4] != GRID_IO_VERSION || header[5] != SUDOKU_SIZE || header[6] > 1 || header[7] != GRID_IO_CELL_BITS)
+    {
+      grid_reader_close (r);
+      errno = EINVAL;
+      return 0;
+    }
+    r->format = header[6] ? GRID_RESULTS : GRID_PUZZLES;
+    r->recordSize = r->format == GRID_RESULTS ? 2 * GRID_IO_GRID_SIZE + GRID_IO_RESULT_FIELDS : GRID_IO_GRID_SIZE;
+    if ((r->nbRecords = grid_io_get (header + 8, 8)) == 0)
+      r->nbRecords = -1;
+    r->pos += GRID_IO_HEADER_SIZE;
+  }
+
+  return r;
+}
+
+grid_format
+grid_reader_format (const grid_reader * r)
+{
+  return r->format;
+}
+
+/// Makes the next line of the input available, reading more of the input if needed.
+/// @param [in,out] r Reader
+/// @return End of the line (its newline, or the end of the input), or null at the end of the input
+static const char *
+grid_reader_line (grid_reader * r)
+{
+  for (size_t scanned = 0;;)
+  {
+    const char *eol = memchr (r->pos + scanned, '\n', r->end - r->pos - scanned);
+
+    if (eol)
+      return eol;
+    else if (r->eof)
+      return r->pos < r->end ? r->end : 0;
+
+    // The line goes on beyond the characters available.
+    scanned = r->end - r->pos;
+    grid_reader_fill (r, scanned + 1);
+  }
+}
+
+/// Counts and reports a line (or record) which does not make a grid.
+/// @param [in,out] r Reader
+/// @param [in] line Number of the line (or record), from 1
+/// @param [in] nbCells Number of values found on the line
+static void
+grid_reader_reject (grid_reader * r, long line, int nbCells)
+{
+  r->nbIncomplete++;
+  if (r->handler)
+    r->handler (line, nbCells);
+}
+
+/// Makes the next binary record available, reading more of the input if needed.
+/// @param [in,out] r Reader
+/// @return The record, or null at the end of the input
+static const unsigned char *
+grid_reader_record (grid_reader * r)
+{
+  if (r->nbRecords >= 0 && r->line >= r->nbRecords)
+    return 0;
+  else if (grid_reader_fill (r, r->recordSize))
+  {
+    const unsigned char *const record = (const unsigned char *) r->pos;
+
+    r->pos += r->recordSize;
+    r->line++;
+    return record;
+  }
+  else if (r->pos < r->end)     // truncated record
+  {
+    grid_reader_reject (r, r->line + 1, (r->end - r->pos) * 8 / GRID_IO_CELL_BITS);
+    r->pos = r->end;
+  }
+  return 0;
+}
+
+int
+grid_reader_read (grid_reader * r, int grids[][GRID_SIZE][GRID_SIZE], int nbGrids)
+{
+  int n = 0;
+
+  if (r->format != GRID_TEXT)
+  {
+    for (const unsigned char *record; n < nbGrids && (record = grid_reader_record (r));)
+    {
+      int i = grid_io_unpack (record, grids[n]);
+
+      if (i == GRID_SIZE * GRID_SIZE)
+        n++;
+      else                      // invalid cell code
+        grid_reader_reject (r, r->line, i);
+    }
+    return n;
+  }
+
+  for (const char *eol; n < nbGrids && (eol = grid_reader_line (r));)
+  {
+    int i = grid_parse (r->pos, eol - r->pos, grids[n]);
+
+    r->line++;
+    r->pos = eol < r->end ? eol + 1 : eol;
+
+    if (i == GRID_SIZE * GRID_SIZE)
+      n++;
+    else if (i)                 // not an empty line
+      grid_reader_reject (r, r->line, i);
+  }
+
+  return n;
+}
+
+int
+grid_reader_read_results (grid_reader * r, int grids[][GRID_SIZE][GRID_SIZE], sudoku_result results[], int nbGrids)
+{
+  int n = 0;
+
+  if (r->format != GRID_RESULTS)
+    return 0;
+
+  for (const unsigned char *record; n < nbGrids && (record = grid_reader_record (r));)
+  {
+    sudoku_result *const result = &results[n];
+    const unsigned char *const fields = record + 2 * GRID_IO_GRID_SIZE;
+
+    memset (result, 0, sizeof (*result));
+
+    int i = grid_io_unpack (record, grids[n]);
+
+    if (i < GRID_SIZE * GRID_SIZE
+        || grid_io_unpack (record + GRID_IO_GRID_SIZE, result->solution) < GRID_SIZE * GRID_SIZE)
+    {
+      grid_reader_reject (r, r->line, i);       // invalid cell code
+      continue;
+    }
+    n++;
+    result->method = result->engine = fields[0] & 0xf;
+    result->status = fields[0] >> 4;
+    result->nbSolutions = grid_io_get (fields + 1, 4);
+    result->nbHypotheses = grid_io_get (fields + 5, 4);
+  }
+  return n;
+}
+
+int
+grid_reader_seek (grid_reader * r, long index)
+{
+  if (!r->map || r->format == GRID_TEXT || index < 0 || index > grid_reader_nb_records (r))
+    return -1;
+
+  r->pos = r->map + GRID_IO_HEADER_SIZE + index * r->recordSize;
+  r->line = index;
+  return 0;
+}
+
+long
+grid_reader_nb_records (const grid_reader * r)
+{
+  if (r->format == GRID_TEXT)
+    return -1;
+  else if (!r->map)
+    return r->nbRecords;
+
+  // A mapped file is never read beyond its end, whatever its header says.
+  long nbRecords = (r->mapSize - GRID_IO_HEADER_SIZE) / r->recordSize;
+
+  return r->nbRecords >= 0 && r->nbRecords < nbRecords ? r->nbRecords : nbRecords;
+}
+
+long
+grid_reader_nb_incomplete (const grid_reader * r)
+{
+  return r->nbIncomplete;
+}
+
+void
+grid_reader_close (grid_reader * r)
+{
+  if (!r)
+    return;
+
+  if (r->map)
+    munmap (r->map, r->mapSize);
+  free (r->buffer);
+  if (r->fd != STDIN_FILENO)
+    close (r->fd);
+  free (r);
+}
+
+/// Definition of a writer of binary records.
+struct grid_writer
+{
+  FILE *file;                   ///< Output
+  grid_format format;           ///< Kind of records
+  uint64_t nbRecords;           ///< Number of records written
+};
+
+grid_writer *
+grid_writer_open (const char *path, grid_format format)
+{
+  FILE *file = strcmp (path, "-") ? fopen (path, "wb") : stdout;
+
+  if (!file)
+    return 0;
+
+  grid_writer *const w = malloc (sizeof (*w));
+
+  if (!w)
+  {
+    fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+  w->file = file;
+  w->format = format == GRID_RESULTS ? GRID_RESULTS : GRID_PUZZLES;
+  w->nbRecords = 0;
+
+  unsigned char header[GRID_IO_HEADER_SIZE] = { 0 };
+
+  memcpy (header, GRID_IO_MAGIC, sizeof (GRID_IO_MAGIC));
+  header[4] = GRID_IO_VERSION;
+  header[5] = SUDOKU_SIZE;
+  header[6] = w->format == GRID_RESULTS;
+  header[7] = GRID_IO_CELL_BITS;
+  fwrite (header, sizeof (header), 1, file);
+
+  return w;
+}
+
+void
+grid_writer_puzzle (grid_writer * w, int g[GRID_SIZE][GRID_SIZE])
+{
+  unsigned char record[GRID_IO_GRID_SIZE];
+
+  grid_io_pack (&g[0][0], record);
+  fwrite (record, sizeof (record), 1, w->file);
+  w->nbRecords++;
+}
+
+void
+grid_writer_result (grid_writer * w, int g[GRID_SIZE][GRID_SIZE], const sudoku_result * result)
+{
+  unsigned char record[2 * GRID_IO_GRID_SIZE + GRID_IO_RESULT_FIELDS];
+  static const int none[GRID_SIZE * GRID_SIZE];
+  unsigned char *const fields = record + 2 * GRID_IO_GRID_SIZE;
+
+  grid_io_pack (&g[0][0], record);
+  grid_io_pack (result->nbSolutions ? &result->solution[0][0] : none, record + GRID_IO_GRID_SIZE);
+  fields[0] = result->method | result->status << 4;
+  grid_io_put (fields + 1, 4, result->nbSolutions);
+  grid_io_put (fields + 5, 4, result->nbHypotheses);
+  fwrite (record, sizeof (record), 1, w->file);
+  w->nbRecords++;
+}
+
+int
+grid_writer_close (grid_writer * w)
+{
+  if (!w)
+    return 0;
+
+  int ret = 0;
+
+  // The number of records can only be recorded if the output is seekable.
+  if (fflush (w->file) == 0 && fseek (w->file, 8, SEEK_SET) == 0)
+  {
+    unsigned char count[8];
+
+    grid_io_put (count, sizeof (count), w->nbRecords);
+    fwrite (count, sizeof (count), 1, w->file);
+  }
+  if (ferror (w->file) || (w->file == stdout ? fflush (w->file) : fclose (w->file)))
+    ret = -1;
+  free (w);
+  return ret;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file
+ * Bulk reader and writer of sudoku grids, as text lines or packed binary records.
+ */
+
+/***********************************************************************************
+* Author: Laurent Farhi                                                            *
+* Name: grid_io.h                                                                  *
+* Language: C                                                                      *
+* Copyright (C) 2009, All rights reserved.                                         *
+*                                                                                  *
+* LICENSE:                                                                         *
+* This program is free software; you can redistribute it and/or modify             *
+* it under the terms of the GNU General Public License as published by             *
+* the Free Software Foundation; either version 2 of the License, or                *
+* (at your option) any later version.                                              *
+*                                                                                  *
+* This program is distributed in the hope that it will be useful,                  *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of                   *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                    *
+* GNU General Public License for more details.                                     *
+*                                                                                  *
+* You should have received a copy of the GNU General Public License                *
+* along with this program; if not, write to the Free Software                      *
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA       *
+***********************************************************************************/
+
+#pragma once
+#ifndef GRID_IO_H
+#define GRID_IO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "solve.h"
+
+/// Formats of the inputs of grids.
+///
+/// A binary file starts with a header of #GRID_IO_HEADER_SIZE bytes: the magic string "SDKB", the version of the format
+/// (1), SUDOKU_SIZE, the kind of records (0 for puzzles, 1 for results), the number of bits per cell, then the number of
+/// records as a little-endian 64-bit integer (0 if unknown, the records then going on up to the end of the file).
+/// Records follow, all of the same size, so that the i-th record lies at offset GRID_IO_HEADER_SIZE + i * (size of a
+/// record), without any index. Cells are packed row by row, least significant bits first, 0 for an empty cell: a
+/// puzzle record is the packed grid, a result record is the packed initial grid, the packed first solution (zeros if
+/// none), one byte holding the method effectively used (low 4 bits) and the status of the search (high 4 bits), then the
+/// numbers of solutions and of hypotheses (little-endian 32-bit integers).
+typedef enum
+{
+  GRID_TEXT,                    ///< Text, one grid per line
+  GRID_PUZZLES,                 ///< Binary puzzle records
+  GRID_RESULTS                  ///< Binary result records
+} grid_format;
+
+enum
+{
+  GRID_IO_HEADER_SIZE = 16,     ///< Size of the header of binary files
+  GRID_IO_CELL_BITS = GRID_SIZE < 8 ? 3 : GRID_SIZE < 16 ? 4 : 5,       ///< Number of bits per cell of binary records
+  GRID_IO_GRID_SIZE = (GRID_SIZE * GRID_SIZE * GRID_IO_CELL_BITS + 7) / 8,      ///< Size of a packed grid
+};
+
+/// Reads a grid from a line of text.
+/// @param [in] text Text of the line (characters other than values and empty cell codes are ignored)
+/// @param [in] length Length of the text
+/// @param [out] g Grid read
+/// @returns The number of values read, GRID_SIZE * GRID_SIZE if the grid is complete.
+/// @pre sudoku_init() has been called.
+int grid_parse (const char *text, size_t length, int g[GRID_SIZE][GRID_SIZE]);
+
+/// Reader of grids, as text (one grid per line) or binary records.
+///
+/// Regular files are mapped in memory, other inputs (pipes, terminals) are read by large chunks.
+/// The format is told by the first bytes of the input.
+/// In text, characters other than values and empty cell codes are ignored, as are empty lines.
+typedef struct grid_reader grid_reader;
+
+/// Handler of the lines (or truncated binary records, or records holding invalid cell codes) which do not hold enough
+/// values to make a grid.
+/// @param [in] line Number of the line (or record), from 1
+/// @param [in] nbCells Number of values found on the line (before the first invalid code of a record)
+typedef void (*grid_reader_error_handler) (long line, int nbCells);
+
+/// Opens a reader of grids.
+/// @param [in] path File to be read, '-' for the standard input
+/// @param [in] handler Function called on each incomplete line, or null
+/// @returns The reader, to be closed by grid_reader_close(), or null if the file can not be opened (errno is then set,
+/// to EINVAL for a binary file of another size or version).
+/// @pre sudoku_init() has been called.
+grid_reader *grid_reader_open (const char *path, grid_reader_error_handler handler);
+
+/// Gets the format of the input of a reader.
+/// @param [in] reader Reader
+/// @returns The format.
+grid_format grid_reader_format (const grid_reader * reader);
+
+/// Reads the next grids.
+/// @param [in] reader Reader
+/// @param [out] grids Grids read, contiguous (initial grids of result records)
+/// @param [in] nbGrids Maximum number of grids to be read
+/// @returns The number of grids read, 0 at the end of the input.
+int grid_reader_read (grid_reader * reader, int grids[][GRID_SIZE][GRID_SIZE], int nbGrids);
+
+/// Reads the next result records.
+/// @param [in] reader Reader of #GRID_RESULTS
+/// @param [out] grids Initial grids read, contiguous
+/// @param [out] results Outcomes read (method, number of solutions and of hypotheses and first solution only)
+/// @param [in] nbGrids Maximum number of records to be read
+/// @returns The number of records read, 0 at the end of the input or if the input does not hold results.
+int grid_reader_read_results (grid_reader * reader, int grids[][GRID_SIZE][GRID_SIZE], sudoku_result results[],
+                              int nbGrids);
+
+/// Moves to a record of a binary file mapped in memory.
+/// @param [in] reader Reader
+/// @param [in] index Index of the record, from 0
+/// @returns 0 on success, -1 if the input is not a binary file mapped in memory or index is out of range.
+int grid_reader_seek (grid_reader * reader, long index);
+
+/// Gets the number of records of a binary input.
+/// @param [in] reader Reader
+/// @returns The number of records, -1 if unknown (text or binary input which is neither counted nor mapped in memory).
+long grid_reader_nb_records (const grid_reader * reader);
+
+/// Gets the number of incomplete lines met so far.
+/// @param [in] reader Reader
+/// @returns The number of lines (or records) which did not hold enough values to make a grid (or held invalid codes).
+long grid_reader_nb_incomplete (const grid_reader * reader);
+
+/// Closes a reader of grids.
+/// @param [in] reader Reader, or null
+void grid_reader_close (grid_reader * reader);
+
+/// Writer of binary records.
+typedef struct grid_writer grid_writer;
+
+/// Opens a writer of binary records.
+/// @param [in] path File to be written, '-' for the standard output
+/// @param [in] format #GRID_PUZZLES or #GRID_RESULTS
+/// @returns The writer, to be closed by grid_writer_close(), or null if the file can not be opened (errno is then set).
+grid_writer *grid_writer_open (const char *path, grid_format format);
+
+/// Writes a puzzle record.
+/// @param [in] writer Writer of #GRID_PUZZLES
+/// @param [in] g Grid
+void grid_writer_puzzle (grid_writer * writer, int g[GRID_SIZE][GRID_SIZE]);
+
+/// Writes a result record.
+/// @param [in] writer Writer of #GRID_RESULTS
+/// @param [in] g Initial grid
+/// @param [in] result Outcome of the resolution of the grid
+void grid_writer_result (grid_writer * writer, int g[GRID_SIZE][GRID_SIZE], const sudoku_result * result);
+
+/// Closes a writer of binary records.
+/// @param [in] writer Writer, or null
+/// @returns 0 on success, -1 on a write error (errno is then set).
+///
+/// The number of records is recorded in the header if the file is seekable.
+int grid_writer_close (grid_writer * writer);
+#endif
@@ -44,6 +44,8 @@
 
 #include "solve.h"
 #include "terminal.h"
+#include "grid_io.h"
+#include "service.h"
 
 /// Called on exit.
 static void
@@ -54,6 +56,28 @@ bye (void)
   printf ("That was all, folks.\n");
 }
 
+/// Converts a character into a cell code.
+/// @param[in] c character to be converted
+/// @return value name, empty cell code, or 0 if the character is to be ignored
+static int
+todigit (int c)
+{
+  if (c == '.')
+    c = sudoku_grid_referential.empty_code;
+
+  char *pc;
+
+  if (c == 0)
+    return 0;
+  else if ((pc = strchr (sudoku_grid_referential.value_name, toupper (c))) ||
+           (pc = strchr (sudoku_grid_referential.value_name, tolower (c))))
+    return (*pc);
+  else if (tolower (c) == tolower (sudoku_grid_referential.empty_code))
+    return (sudoku_grid_referential.empty_code);
+  else
+    return 0;
+}
+
 /// Read the next digit from string
 /// @param[in] initString string to be read
 /// @return read character or \c EOF if no more digits found
@@ -85,18 +109,12 @@ getdigit (const char *initString)
       pos = 0;                  // stops processing if getdigit is still called when end of initString has been reached already.
     }
 
-    if (c == '.')
-      c = sudoku_grid_referential.empty_code;
-
-    char *pc;
+    int d;
 
-    if ((pc = strchr (sudoku_grid_referential.value_name, toupper (c))) ||
-        (pc = strchr (sudoku_grid_referential.value_name, tolower (c))))
-      return (*pc);
-    else if (tolower (c) == tolower (sudoku_grid_referential.empty_code))
-      return (sudoku_grid_referential.empty_code);
-    else if (c == EOF)
+    if (c == EOF)
       return (c);
+    else if ((d = todigit (c)))
+      return (d);
   }
   while (1);
 
@@ -104,6 +122,192 @@ getdigit (const char *initString)
   exit (-1);
 }
 
+/// Number of grids read from the input stream before being solved by batch.
+#define BATCH_SIZE 4096
+
+/// Writes the outcome of the resolution of a grid on one line.
+/// @param[in] g Initial grid
+/// @param[in] result Outcome of the resolution of the grid
+static void
+result_print (int g[GRID_SIZE][GRID_SIZE], const sudoku_result * result)
+{
+  char solution[GRID_SIZE * GRID_SIZE + 1];
+  int i;
+
+  for (i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+  {
+    int v = result->nbSolutions ? result->solution[i / GRID_SIZE][i % GRID_SIZE] : g[i / GRID_SIZE][i % GRID_SIZE];
+
+    solution[i] = v > 0 && v <= GRID_SIZE ? sudoku_grid_referential.value_name[v - 1] : '.';
+  }
+  solution[i] = 0;
+
+  printf ("%s %s %i %i%s\n", solution,
+          (result->method == EXACT_COVER ? "EXACT_COVER" : result->method == BACKTRACKING ? "BACKTRACKING" :
+           result->method == ELIMINATION ? "ELIMINATION" : "NONE"), result->nbHypotheses,
+          (result->method == EXACT_COVER ? 3 : result->method == BACKTRACKING ? 2 : result->method ==
+           ELIMINATION ? 1 : 0),
+          (result->status == SEARCH_DEADLINE ? " DEADLINE" : result->status == SEARCH_BUDGET ? " BUDGET" :
+           result->status == SEARCH_CANCELLED ? " CANCELLED" : ""));
+}
+
+/// Reports an incomplete line of batch mode.
+/// @param[in] line Number of the line
+/// @param[in] nbCells Number of values found on the line
+static void
+batch_incomplete (long line, int nbCells)
+{
+  fprintf (stderr, "Line %1$li: incomplete grid (%2$i values provided for initialization, %3$i values needed.)\n",
+           line, nbCells, GRID_SIZE * GRID_SIZE);
+}
+
+/// Solves grids in a row, one grid per line.
+/// @param[in] input Reader of grids
+/// @param[in] method Method selected for solving the grids
+/// @param[in] find \c FIRST to find the first solution or \c ALL to find all solutions
+/// @param[in] nbThreads Number of threads solving grids, 0 for as many as online processors
+/// @param[in] output Writer of binary result records, or null
+/// @return 0 if all the lines of the stream could be read as grids, -1 otherwise
+///
+/// Writes one line per grid on standard output (or one record to output), in the order of the input stream: the solution
+/// (or the initial grid if no solution was found), the method effectively used, the number of hypotheses and the status
+/// code (as returned by solveSudoku for one grid).
+static int
+batch_solve (grid_reader * input, method method, findSolutions find, int nbThreads, grid_writer * output)
+{
+  int (*grids)[GRID_SIZE][GRID_SIZE] = malloc (BATCH_SIZE * sizeof (*grids));
+  sudoku_result *results = malloc (BATCH_SIZE * sizeof (*results));
+
+  if (!grids || !results)
+  {
+    fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+
+  for (int n; (n = grid_reader_read (input, grids, BATCH_SIZE));)
+  {
+    sudoku_solve_batch (grids, n, method, find, nbThreads, results);
+    for (int i = 0; i < n; i++)
+      if (output)
+        grid_writer_result (output, grids[i], &results[i]);
+      else
+        result_print (grids[i], &results[i]);
+  }
+
+  free (results);
+  free (grids);
+  return grid_reader_nb_incomplete (input) ? -1 : 0;
+}
+
+/// Converts grids between text lines and binary records.
+/// @param[in] input Reader of grids
+/// @return 0 if all the lines of the stream could be read as grids and written, -1 otherwise
+///
+/// Text lines are written as binary puzzle records on standard output, binary puzzle records as text lines, and binary
+/// result records as the lines of batch mode.
+static int
+grids_convert (grid_reader * input)
+{
+  const grid_format format = grid_reader_format (input);
+  grid_writer *output = format == GRID_TEXT ? grid_writer_open ("-", GRID_PUZZLES) : 0;
+  int (*grids)[GRID_SIZE][GRID_SIZE] = malloc (BATCH_SIZE * sizeof (*grids));
+  sudoku_result *results = malloc (BATCH_SIZE * sizeof (*results));
+
+  if (!grids || !results || (format == GRID_TEXT && !output))
+  {
+    fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+
+  for (int n;
+       (n = format == GRID_RESULTS ? grid_reader_read_results (input, grids, results, BATCH_SIZE) :
+        grid_reader_read (input, grids, BATCH_SIZE));)
+    for (int i = 0; i < n; i++)
+      if (output)
+        grid_writer_puzzle (output, grids[i]);
+      else if (format == GRID_RESULTS)
+        result_print (grids[i], &results[i]);
+      else
+      {
+        char puzzle[GRID_SIZE * GRID_SIZE + 1];
+        int j;
+
+        for (j = 0; j < GRID_SIZE * GRID_SIZE; j++)
+        {
+          int v = grids[i][j / GRID_SIZE][j % GRID_SIZE];
+
+          puzzle[j] = v > 0 && v <= GRID_SIZE ? sudoku_grid_referential.value_name[v - 1] : '.';
+        }
+        puzzle[j] = 0;
+        printf ("%s\n", puzzle);
+      }
+
+  int ret = grid_reader_nb_incomplete (input) ? -1 : 0;
+
+  if (grid_writer_close (output))
+  {
+    perror ("-");
+    ret = -1;
+  }
+  free (results);
+  free (grids);
+  return ret;
+}
+
+/// Generates puzzles, one per line.
+/// @param[in] nbPuzzles Number of puzzles to generate
+/// @param[in] seed Seed of the pseudo-random generator
+/// @param[in] grade Non-zero to grade the puzzles
+/// @param[in] nbThreads Number of threads generating puzzles, 0 for as many as online processors
+///
+/// Writes one line per puzzle on standard output, which can be read back in batch mode: the puzzle, and if graded,
+/// the method effectively used to solve it, the number of hypotheses, the status code and the grade of the puzzle.
+static void
+batch_generate (long nbPuzzles, unsigned long seed, int grade, int nbThreads)
+{
+  sudoku_puzzle *puzzles = malloc (BATCH_SIZE * sizeof (*puzzles));
+
+  if (!puzzles)
+  {
+    fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+
+  for (long first = 0; first < nbPuzzles; first += BATCH_SIZE)
+  {
+    int n = nbPuzzles - first < BATCH_SIZE ? nbPuzzles - first : BATCH_SIZE;
+
+    // Each batch of puzzles gets a seed of its own.
+    sudoku_generate_batch (puzzles, n, seed + first * 0x2545f4914f6cdd1dUL, grade, nbThreads);
+    for (int i = 0; i < n; i++)
+    {
+      char puzzle[GRID_SIZE * GRID_SIZE + 1];
+      int j;
+
+      for (j = 0; j < GRID_SIZE * GRID_SIZE; j++)
+      {
+        int v = puzzles[i].grid[j / GRID_SIZE][j % GRID_SIZE];
+
+        puzzle[j] = v ? sudoku_grid_referential.value_name[v - 1] : '.';
+      }
+      puzzle[j] = 0;
+
+      const sudoku_result *const result = &puzzles[i].result;
+
+      if (grade)
+        printf ("%s %s %i %i %i\n", puzzle,
+                (result->method == EXACT_COVER ? "EXACT_COVER" : result->method == BACKTRACKING ? "BACKTRACKING" :
+                 result->method == ELIMINATION ? "ELIMINATION" : "NONE"), result->nbHypotheses,
+                (result->method == EXACT_COVER ? 3 : result->method == BACKTRACKING ? 2 : result->method ==
+                 ELIMINATION ? 1 : 0), puzzles[i].grade);
+      else
+        printf ("%s\n", puzzle);
+    }
+  }
+
+  free (puzzles);
+}
+
 /// Well, that's the entry point.
 int
 main (int argc, char *argv[])
@@ -138,9 +342,19 @@ main (int argc, char *argv[])
   int test = -1;
   int iflag = 0;
   int quiet = 0;
+  const char *batch = 0;
+  const char *batchOutput = 0;
+  const char *convert = 0;
+  const char *serve = 0;
+  int nbThreads = 1;
+  long generate = -1;
+  unsigned long seed = time (0);
+  int grade = 0;
+  int cacheCapacity = 0;
+  sudoku_limits limits = { 0, 0 };
 
   // Command-line options
-  const char options[] = "qivgrchfBET:";
+  const char options[] = "qivgrchfBEAT:b:j:p:d:t:G:s:RC:o:X:S:M:N:";
 
   opterr = 1;
   for (int letter = 0; (letter = getopt (argc, argv, options)) >= 0;)
@@ -155,7 +369,12 @@ main (int argc, char *argv[])
       printf ("Name:\n  %s\n", basename (argv[0]));
       printf ("\nDescription:\n  Sudoku Solver using logical rules for elimination of candidates.\n");
       printf ("\nVersion:\n  %s\n", sudoku_get_version ());
-      printf ("\nUsage:\n  %s [-vh] [-fBE] [-igcrq] [-T n] [grid]\n", basename (argv[0]));
+      printf ("\nUsage:\n  %s [-vh] [-fBEA] [-igcrq] [-p n] [-d n] [-t n] [-M ms] [-N n] [-T n] [grid]\n",
+              basename (argv[0]));
+      printf ("  %s [-fBEA] [-j n] [-C n] [-M ms] [-N n] [-o file] -b file\n", basename (argv[0]));
+      printf ("  %s [-fBEA] [-j n] [-C n] [-M ms] [-N n] -S address\n", basename (argv[0]));
+      printf ("  %s -X file\n", basename (argv[0]));
+      printf ("  %s [-R] [-s seed] [-j n] -G n\n", basename (argv[0]));
       printf ("\nArgument:\n");
       printf ("    'grid' is the sequence of the %1$i characters (%2$ix%3$i cells) of the sudoku grid :\n",
               GRID_SIZE * GRID_SIZE, GRID_SIZE, GRID_SIZE);
@@ -178,11 +397,21 @@ main (int argc, char *argv[])
       printf ("\n");
       printf ("  Solving options:\n");
       printf ("   -f\tSearch for the first solution only rather than all of them\n");
+      printf ("   -p n\tExplore the first n levels of hypotheses with parallel threads (elimination method, with -q only)\n");
+      printf ("   -d n\tLimit the size of the subsets searched by logical rules to n (elimination method)\n");
+      printf ("   -t n\tApply logical rules by increasing cost, and make a hypothesis on a cell with two candidates\n"
+              "\trather than searching subsets larger than n (never if n is 0) (elimination method)\n");
+      printf ("   -M ms\tStop the search of each grid after ms milliseconds (elimination and backtracking methods)\n");
+      printf ("   -N n\tStop the search of each grid after n hypotheses (elimination and backtracking methods);\n"
+              "\tin batch mode, the line of a grid whose search was stopped by -M or -N ends with DEADLINE\n"
+              "\tor BUDGET, the solutions and hypotheses being those found so far\n");
       printf ("\n");
       printf ("  Default method is elimination method (human like, using logical rules.)\n"
               "  Other methods are optionnally available :\n");
       printf ("   -B\tSolve using backtracking method (brute force)\n");
       printf ("   -E\tSolve using exact cover search method (dancing links)\n");
+      printf ("   -A\tSolve using the fastest of elimination and backtracking methods, raced in parallel\n"
+              "\t(with -q or -b only, otherwise picked from the number of givens)\n");
       printf ("\n");
       printf ("  Display options for elimination method only:\n");
       printf ("   -i\tInteractive mode (step by step)\n");
@@ -191,6 +420,36 @@ main (int argc, char *argv[])
       printf ("   -r\tDisplay logical rules\n");
       printf ("   -q\tCompletely quiet\n");
       printf ("\n");
+      printf ("  Batch mode:\n");
+      printf ("   -b file\tSolve each line of file as a grid ('-' for the standard input), quietly.\n"
+              "\tOne line is written per grid: the solution (or the initial grid if no solution was found),\n"
+              "\tthe method used, the number of hypotheses and the return value for this grid.\n"
+              "\tThe file can also hold binary puzzle records (see -X).\n");
+      printf ("   -o file\tWrite the outcomes of batch mode to file as binary result records rather than lines\n");
+      printf ("   -j n\tSolve grids of batch mode with n threads (0 for as many as processors, default 1)\n");
+      printf ("   -C n\tKeep the results of up to n grids, so that repeated or equivalent grids are solved once;\n"
+              "\tthe numbers of hits and misses are written on the standard error\n");
+      printf ("\n");
+      printf ("  Service mode:\n");
+      printf ("   -S address\tServe requests 'ID GRID', one per line, on address: '-' for the standard input and\n"
+              "\toutput, a path (holding a '/') for a Unix socket, or [host:]port for TCP (host is localhost\n"
+              "\tif omitted, all interfaces if empty). Each request is answered by 'ID' followed by the line of\n"
+              "\tbatch mode, or by 'ID ERROR reason'; responses are written as soon as grids are solved,\n"
+              "\tin any order. -j and -C apply.\n");
+      printf ("\n");
+      printf ("  Conversion mode:\n");
+      printf ("   -X file\tConvert file ('-' for the standard input) to the standard output: lines of grids to\n"
+              "\tbinary puzzle records (%i bits per cell), binary puzzle records to lines of grids,\n"
+              "\tand binary result records (written by -o) to the lines of batch mode.\n", GRID_IO_CELL_BITS);
+      printf ("\n");
+      printf ("  Generation mode:\n");
+      printf ("   -G n\tGenerate n minimal puzzles with a unique solution, one per line.\n");
+      printf ("   -R\tGrade the generated puzzles: each line is then followed by the method used, the number of\n"
+              "\thypotheses and the return value when solving it, and the size of the largest subset\n"
+              "\tneeded by logical rules (%i more than the number of hypotheses if not enough).\n", GRID_SIZE);
+      printf ("   -s seed\tSeed of the generation (default is the current time)\n");
+      printf ("   -j n\tGenerate puzzles with n threads (0 for as many as processors, default 1)\n");
+      printf ("\n");
       printf ("  Options for test purpose:\n");
       printf ("   -T n\tSolve test grid number n, n between 1 and %lu (for test purpose)\n",
               sizeof (TEST_GRID) / sizeof (const char *));
@@ -198,7 +457,8 @@ main (int argc, char *argv[])
       printf ("Return value:\n"
               "    0\tNo solution were found.\n"
               "    1\tA solution was found, without using backtracking.\n"
-              "    2\tA solution was found, using backtracking.\n");
+              "    2\tA solution was found, using backtracking.\n"
+              "    3\tA solution was found, using exact cover search.\n");
 
       exit (0);
     }
@@ -221,8 +481,112 @@ main (int argc, char *argv[])
       method = BACKTRACKING;
     else if (letter == 'E')
       method = EXACT_COVER;
+    else if (letter == 'A')
+      method = AUTO;
     else if (letter == 'q')
       quiet = 1;
+    else if (letter == 'b')
+      batch = optarg;
+    else if (letter == 'o')
+      batchOutput = optarg;
+    else if (letter == 'X')
+      convert = optarg;
+    else if (letter == 'S')
+      serve = optarg;
+    else if (letter == 'j')
+    {
+      char *endptr = 0;
+
+      if ((nbThreads = strtol (optarg, &endptr, 10)) < 0 || *endptr)
+      {
+        fprintf (stderr, "Invalid option argument for option -j: positive number expected.\n");
+        exit (-1);
+      }
+    }
+    else if (letter == 'C')
+    {
+      char *endptr = 0;
+
+      if ((cacheCapacity = strtol (optarg, &endptr, 10)) < 1 || *endptr)
+      {
+        fprintf (stderr, "Invalid option argument for option -C: positive number expected.\n");
+        exit (-1);
+      }
+    }
+    else if (letter == 'M' || letter == 'N')
+    {
+      char *endptr = 0;
+      long value = strtol (optarg, &endptr, 10);
+
+      if (value < 0 || *endptr)
+      {
+        fprintf (stderr, "Invalid option argument for option -%c: positive number expected.\n", letter);
+        exit (-1);
+      }
+      else if (letter == 'M')
+        limits.timeout = value / 1000.;
+      else
+        limits.maxHypotheses = value;
+    }
+    else if (letter == 'p')
+    {
+      char *endptr = 0;
+      int depth = strtol (optarg, &endptr, 10);
+
+      if (depth < 0 || *endptr)
+      {
+        fprintf (stderr, "Invalid option argument for option -p: positive number expected.\n");
+        exit (-1);
+      }
+      sudoku_parallel_depth_set (depth);
+    }
+    else if (letter == 'd')
+    {
+      char *endptr = 0;
+      int depth = strtol (optarg, &endptr, 10);
+
+      if (depth < 0 || *endptr)
+      {
+        fprintf (stderr, "Invalid option argument for option -d: positive number expected.\n");
+        exit (-1);
+      }
+      sudoku_subset_depth_set (depth);
+    }
+    else if (letter == 't')
+    {
+      char *endptr = 0;
+      sudoku_schedule schedule = { 0, 0, strtol (optarg, &endptr, 10) };
+
+      if (schedule.hypothesisDepth < 0 || *endptr)
+      {
+        fprintf (stderr, "Invalid option argument for option -t: positive number expected.\n");
+        exit (-1);
+      }
+      sudoku_schedule_set (&schedule);
+    }
+    else if (letter == 'G')
+    {
+      char *endptr = 0;
+
+      if ((generate = strtol (optarg, &endptr, 10)) < 0 || *endptr)
+      {
+        fprintf (stderr, "Invalid option argument for option -G: positive number expected.\n");
+        exit (-1);
+      }
+    }
+    else if (letter == 's')
+    {
+      char *endptr = 0;
+
+      seed = strtoul (optarg, &endptr, 10);
+      if (*endptr)
+      {
+        fprintf (stderr, "Invalid option argument for option -s: positive number expected.\n");
+        exit (-1);
+      }
+    }
+    else if (letter == 'R')
+      grade = 1;
     else if (letter == 'T')
     {
       char *endptr = 0;
@@ -232,11 +596,86 @@ main (int argc, char *argv[])
     }
   }
 
+  sudoku_limits_set (&limits);
+
+  if (generate >= 0)
+  {
+    batch_generate (generate, seed, grade, nbThreads);
+    exit (0);
+  }
+
+  if (convert)
+  {
+    grid_reader *input = grid_reader_open (convert, batch_incomplete);
+
+    if (!input)
+    {
+      perror (convert);
+      exit (-1);
+    }
+
+    int ret = grids_convert (input);
+
+    grid_reader_close (input);
+    exit (ret);
+  }
+
+  if (serve)
+  {
+    sudoku_cache *cache = cacheCapacity ? sudoku_cache_create (cacheCapacity) : 0;
+    int ret = service_run (serve, method, find, nbThreads, cache, &limits);
+
+    sudoku_cache_destroy (cache);
+    exit (ret);
+  }
+
+  if (batch)
+  {
+    grid_reader *input = grid_reader_open (batch, batch_incomplete);
+
+    if (!input)
+    {
+      perror (batch);
+      exit (-1);
+    }
+
+    sudoku_cache *cache = cacheCapacity ? sudoku_cache_create (cacheCapacity) : 0;
+
+    sudoku_cache_set (cache);
+
+    grid_writer *output = batchOutput ? grid_writer_open (batchOutput, GRID_RESULTS) : 0;
+
+    if (batchOutput && !output)
+    {
+      perror (batchOutput);
+      exit (-1);
+    }
+
+    int ret = batch_solve (input, method, find, nbThreads, output);
+
+    grid_reader_close (input);
+    if (grid_writer_close (output))
+    {
+      perror (batchOutput);
+      ret = -1;
+    }
+    if (cache)
+    {
+      sudoku_cache_counters counters;
+
+      sudoku_cache_counters_get (cache, &counters);
+      fprintf (stderr, "Cache: %lli hits, %lli misses.\n", counters.hits, counters.misses);
+      sudoku_cache_destroy (sudoku_cache_set (0));
+    }
+    exit (ret);
+  }
+
   if (!quiet)
   {
     printf ("Method : %s.\n",
             (method == EXACT_COVER ? "exact cover search (-E)" : method ==
-             BACKTRACKING ? "backtracking (-B)" : "elimination of candidates"));
+             BACKTRACKING ? "backtracking (-B)" : method ==
+             AUTO ? "fastest of elimination and backtracking (-A)" : "elimination of candidates"));
     if (find == ALL)
       printf ("Searching all solutions.\n");
     else
@@ -0,0 +1,497 @@
+/**
+ * @file
+ * Sudoku solver service.
+ */
+
+/***********************************************************************************
+* Author: Laurent Farhi                                                            *
+* Name: service.c                                                                  *
+* Language: C                                                                      *
+* Copyright (C) 2009, All rights reserved.                                         *
+*                                                                                  *
+* LICENSE:                                                                         *
+* This program is free software; you can redistribute it and/or modify             *
+* it under the terms of the GNU General Public License as published by             *
+* the Free Software Foundation; either version 2 of the License, or                *
+* (at your option) any later version.                                              *
+*                                                                                  *
+* This program is distributed in the hope that it will be useful,                  *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of                   *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                    *
+* GNU General Public License for more details.                                     *
+*                                                                                  *
+* You should have received a copy of the GNU General Public License                *
+* along with this program; if not, write to the Free Software                      *
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA       *
+***********************************************************************************/
+
+#define _XOPEN_SOURCE
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "solve.h"
+#include "grid_io.h"
+#include "service.h"
+
+/// Number of requests waiting for a thread, per thread, after which requests are no longer read.
+#define SERVICE_QUEUE_PER_THREAD 256
+
+/// Size of the first buffer reading the requests of a connection.
+#define SERVICE_BUFFER_SIZE (1 << 16)
+
+/// Length of a line of request after which the connection is no longer read.
+#define SERVICE_LINE_MAX (1 << 20)
+
+/// Definition of a service.
+typedef struct
+{
+  pthread_mutex_t mutex;        ///< Lock of the queue of requests
+  pthread_cond_t notEmpty;      ///< Signaled when a request is queued
+  pthread_cond_t notFull;       ///< Signaled when a request is dequeued
+  struct request *first;        ///< First request of the queue
+  struct request *last;         ///< Last request of the queue
+  int nbRequests;               ///< Number of requests in the queue
+  int maxRequests;              ///< Maximum number of requests in the queue
+  method method;                ///< Method selected for solving the grids
+  findSolutions find;           ///< \c FIRST to find the first solution or \c ALL to find all solutions
+  sudoku_cache *cache;          ///< Cache of results shared by the threads, or null
+  const sudoku_limits *limits;  ///< Limits of each resolution, or null
+} service;
+
+/// Definition of a connection to a service.
+typedef struct
+{
+  service *s;                   ///< Service
+  int in;                       ///< File descriptor of the requests
+  int out;                      ///< File descriptor of the responses
+  int owned;                    ///< 1 if the connection is closed and freed once its requests are answered
+  pthread_mutex_t mutex;        ///< Lock of the responses and of the state below
+  pthread_cond_t answered;      ///< Signaled when the last pending request is answered
+  int pending;                  ///< Number of requests read and not answered yet
+  int reading;                  ///< 1 while requests are being read
+  int broken;                   ///< 1 if responses can no longer be written
+} connection;
+
+/// Definition of a request.
+typedef struct request
+{
+  connection *c;                ///< Connection of the request
+  char id[SERVICE_ID_LENGTH + 1];       ///< Identifier of the request
+  int grid[GRID_SIZE][GRID_SIZE];       ///< Grid to be solved
+  struct request *next;         ///< Next request of the queue
+} request;
+
+/// Creates a connection.
+/// @param [in] s Service
+/// @param [in] in File descriptor of the requests
+/// @param [in] out File descriptor of the responses
+/// @param [in] owned 1 if the connection is to be closed and freed once its requests are answered
+/// @return Connection
+static connection *
+connection_create (service * s, int in, int out, int owned)
+{
+  connection *const c = calloc (1, sizeof (*c));
+
+  if (!c || pthread_mutex_init (&c->mutex, 0) || pthread_cond_init (&c->answered, 0))
+  {
+    fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+  c->s = s;
+  c->in = in;
+  c->out = out;
+  c->owned = owned;
+  c->reading = 1;
+  return c;
+}
+
+/// Destroys a connection, closing its file descriptors if owned.
+/// @param [in] c Connection
+static void
+connection_destroy (connection * c)
+{
+  if (c->owned)
+  {
+    close (c->in);
+    if (c->out != c->in)
+      close (c->out);
+  }
+  pthread_cond_destroy (&c->answered);
+  pthread_mutex_destroy (&c->mutex);
+  free (c);
+}
+
+/// Unlocks a connection, and destroys it if owned and done with.
+/// @param [in] c Connection, locked
+static void
+connection_release (connection * c)
+{
+  int done = !c->reading && !c->pending;
+  int destroy = done && c->owned;       // read before unlocking, as a connection not owned may be destroyed then
+
+  if (done)
+    pthread_cond_broadcast (&c->answered);
+  pthread_mutex_unlock (&c->mutex);
+  if (destroy)
+    connection_destroy (c);
+}
+
+/// Writes the response to a request of a connection.
+/// @param [in] c Connection
+/// @param [in] response Line of response, newline included
+/// @param [in] length Length of the line
+static void
+connection_respond (connection * c, const char *response, size_t length)
+{
+  pthread_mutex_lock (&c->mutex);
+  for (ssize_t n; length && !c->broken; response += n, length -= n)
+    if ((n = write (c->out, response, length)) < 0)
+    {
+      if (errno == EINTR)
+        n = 0;
+      else
+        c->broken = 1;          // the peer is gone: its other responses are dropped
+    }
+  c->pending--;
+  connection_release (c);
+}
+
+/// Reads a request of a connection, and queues it.
+/// @param [in] c Connection
+/// @param [in] line Line of the request, without newline
+/// @param [in] length Length of the line
+static void
+connection_request (connection * c, const char *line, size_t length)
+{
+  const char *const end = line + length;
+  const char *id = line;
+
+  while (id < end && (*id == ' ' || *id == '\t' || *id == '\r'))
+    id++;
+
+  const char *grid = id;
+
+  while (grid < end && *grid != ' ' && *grid != '\t' && *grid != '\r')
+    grid++;
+  if (grid == id)               // empty line
+    return;
+
+  request *const r = malloc (sizeof (*r));
+
+  if (!r)
+  {
+    fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+  r->c = c;
+  r->next = 0;
+  snprintf (r->id, sizeof (r->id), "%.*s", (int) (grid - id), id);
+
+  pthread_mutex_lock (&c->mutex);
+  c->pending++;
+  pthread_mutex_unlock (&c->mutex);
+
+  int nbCells = grid_parse (grid, end - grid, r->grid);
+
+  if (nbCells < GRID_SIZE * GRID_SIZE || grid - id > SERVICE_ID_LENGTH)
+  {
+    char response[2 * SERVICE_ID_LENGTH];
+    int n = grid - id > SERVICE_ID_LENGTH ?
+      snprintf (response, sizeof (response), "%s ERROR identifier too long\n", r->id) :
+      snprintf (response, sizeof (response), "%s ERROR incomplete grid (%i values, %i needed)\n", r->id, nbCells,
+                GRID_SIZE * GRID_SIZE);
+
+    connection_respond (c, response, n);
+    free (r);
+    return;
+  }
+
+  service *const s = c->s;
+
+  pthread_mutex_lock (&s->mutex);
+  while (s->nbRequests >= s->maxRequests)
+    pthread_cond_wait (&s->notFull, &s->mutex);
+  if (s->last)
+    s->last->next = r;
+  else
+    s->first = r;
+  s->last = r;
+  s->nbRequests++;
+  pthread_cond_signal (&s->notEmpty);
+  pthread_mutex_unlock (&s->mutex);
+}
+
+/// Reads the requests of a connection until its input ends.
+/// @param [in] c Connection
+static void
+connection_read (connection * c)
+{
+  size_t size = SERVICE_BUFFER_SIZE;
+  size_t length = 0;
+  char *buffer = malloc (size);
+
+  if (!buffer)
+  {
+    fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+
+  for (ssize_t n;;)
+  {
+    if (length == size)
+    {
+      if (size >= SERVICE_LINE_MAX)
+        break;
+      else if (!(buffer = realloc (buffer, size *= 2)))
+      {
+        fprintf (stderr, "Memory allocation error (%s, %s, %i)\n", __func__, __FILE__, __LINE__);
+        exit (-1);
+      }
+    }
+    while ((n = read (c->in, buffer + length, size - length)) < 0 && errno == EINTR)
+      /* nothing */ ;
+    if (n <= 0)
+    {
+      if (length)               // last line, without newline
+        connection_request (c, buffer, length);
+      break;
+    }
+
+    // Requests are queued as soon as their line is complete (the bytes read before hold no newline).
+    const char *line = buffer;
+    const char *const end = buffer + length + n;
+
+    for (const char *eol, *from = buffer + length; (eol = memchr (from, '\n', end - from)); from = line = eol + 1)
+      connection_request (c, line, eol - line);
+    length = end - line;
+    memmove (buffer, line, length);
+  }
+  free (buffer);
+
+  pthread_mutex_lock (&c->mutex);
+  c->reading = 0;
+  connection_release (c);
+}
+
+/// Thread reading the requests of a connection.
+/// @param [in] arg Connection
+/// @return 0
+static void *
+connection_thread (void *arg)
+{
+  connection_read (arg);
+  return 0;
+}
+
+/// Thread of the pool of a service, solving the requests of all the connections.
+/// @param [in] arg Service
+/// @return never
+static void *
+service_work (void *arg)
+{
+  service *const s = arg;
+  sudoku_context *const ctx = sudoku_context_create ();
+
+  sudoku_context_cache_set (ctx, s->cache);
+  sudoku_context_limits_set (ctx, s->limits);
+  for (;;)
+  {
+    pthread_mutex_lock (&s->mutex);
+    while (!s->first)
+      pthread_cond_wait (&s->notEmpty, &s->mutex);
+
+    request *const r = s->first;
+
+    if (!(s->first = r->next))
+      s->last = 0;
+    s->nbRequests--;
+    pthread_cond_signal (&s->notFull);
+    pthread_mutex_unlock (&s->mutex);
+
+    sudoku_result result;
+    char response[SERVICE_ID_LENGTH + GRID_SIZE * GRID_SIZE + 64];
+    int n = snprintf (response, sizeof (response), "%s ", r->id);
+
+    sudoku_solve_ctx (ctx, r->grid, s->method, s->find, &result);
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+    {
+      int v = result.nbSolutions ? result.solution[i / GRID_SIZE][i % GRID_SIZE] : r->grid[i / GRID_SIZE][i % GRID_SIZE];
+
+      response[n++] = v ? sudoku_grid_referential.value_name[v - 1] : '.';
+    }
+    n += snprintf (response + n, sizeof (response) - n, " %s %i %i%s\n",
+                   (result.method == EXACT_COVER ? "EXACT_COVER" : result.method == BACKTRACKING ? "BACKTRACKING" :
+                    result.method == ELIMINATION ? "ELIMINATION" : "NONE"), result.nbHypotheses,
+                   (result.method == EXACT_COVER ? 3 : result.method == BACKTRACKING ? 2 : result.method ==
+                    ELIMINATION ? 1 : 0),
+                   (result.status == SEARCH_DEADLINE ? " DEADLINE" : result.status == SEARCH_BUDGET ? " BUDGET" :
+                    result.status == SEARCH_CANCELLED ? " CANCELLED" : ""));
+    connection_respond (r->c, response, n);
+    free (r);
+  }
+  return 0;
+}
+
+/// Opens the socket of a service.
+/// @param [in] address Path (with a '/') of a Unix socket, or [host:]port for TCP
+/// @return Listening socket, -1 on error (an error message is then written)
+static int
+service_listen (const char *address)
+{
+  int fd = -1;
+
+  if (strchr (address, '/'))
+  {
+    struct sockaddr_un un = {.sun_family = AF_UNIX };
+
+    if (strlen (address) >= sizeof (un.sun_path))
+    {
+      fprintf (stderr, "%s: path of socket too long.\n", address);
+      return -1;
+    }
+    strcpy (un.sun_path, address);
+
+    // A socket left by a previous run is replaced.
+    struct stat st;
+
+    if (stat (address, &st) == 0 && S_ISSOCK (st.st_mode))
+      unlink (address);
+    if ((fd = socket (AF_UNIX, SOCK_STREAM, 0)) < 0 || bind (fd, (struct sockaddr *) &un, sizeof (un))
+        || listen (fd, SOMAXCONN))
+    {
+      perror (address);
+      if (fd >= 0)
+        close (fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  const char *colon = strrchr (address, ':');
+  char host[256] = "localhost";
+
+  if (colon)
+    snprintf (host, sizeof (host), "%.*s", (int) (colon - address), address);
+
+  struct addrinfo hints = {.ai_family = AF_UNSPEC,.ai_socktype = SOCK_STREAM,.ai_flags = AI_PASSIVE };
+  struct addrinfo *ai;
+  int err = getaddrinfo (*host ? host : 0, colon ? colon + 1 : address, &hints, &ai);       // ":port" for all interfaces
+
+  if (err)
+  {
+    fprintf (stderr, "%s: %s.\n", address, gai_strerror (err));
+    return -1;
+  }
+  for (struct addrinfo * p = ai; p && fd < 0; p = p->ai_next)
+    if ((fd = socket (p->ai_family, p->ai_socktype, p->ai_protocol)) >= 0)
+    {
+      int on = 1;
+
+      setsockopt (fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof (on));
+      if (bind (fd, p->ai_addr, p->ai_addrlen) || listen (fd, SOMAXCONN))
+      {
+        err = errno;
+        close (fd);
+        fd = -1;
+      }
+    }
+  freeaddrinfo (ai);
+  if (fd < 0)
+  {
+    errno = err;
+    perror (address);
+  }
+  return fd;
+}
+
+int
+service_run (const char *address, method method, findSolutions find, int nbThreads, sudoku_cache * cache,
+             const sudoku_limits * limits)
+{
+  static service s = {.mutex = PTHREAD_MUTEX_INITIALIZER,.notEmpty = PTHREAD_COND_INITIALIZER,.notFull =
+      PTHREAD_COND_INITIALIZER
+  };
+  int listener = strcmp (address, "-") ? service_listen (address) : -1;
+
+  if (strcmp (address, "-") && listener < 0)
+    return -1;
+
+  // Responses to closed connections fail instead of killing the process.
+  signal (SIGPIPE, SIG_IGN);
+
+  if (nbThreads <= 0)
+    nbThreads = sysconf (_SC_NPROCESSORS_ONLN);
+  if (nbThreads <= 0)
+    nbThreads = 1;
+  s.method = method;
+  s.find = find;
+  s.cache = cache;
+  s.limits = limits;
+  s.maxRequests = nbThreads * SERVICE_QUEUE_PER_THREAD;
+
+  // The pool of threads is started once for all the connections.
+  for (int i = 0; i < nbThreads; i++)
+  {
+    pthread_t thread;
+
+    if (pthread_create (&thread, 0, service_work, &s) || pthread_detach (thread))
+    {
+      fprintf (stderr, "Unexpected error (%s, %s, %i).\n", __func__, __FILE__, __LINE__);
+      exit (-1);
+    }
+  }
+
+  if (listener < 0)
+  {
+    connection *const c = connection_create (&s, STDIN_FILENO, STDOUT_FILENO, 0);
+
+    connection_read (c);
+    pthread_mutex_lock (&c->mutex);
+    while (c->pending)
+      pthread_cond_wait (&c->answered, &c->mutex);
+    pthread_mutex_unlock (&c->mutex);
+    connection_destroy (c);
+    return 0;
+  }
+
+  for (;;)
+  {
+    int fd = accept (listener, 0, 0);
+
+    if (fd < 0)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      perror ("accept");
+      close (listener);
+      return -1;
+    }
+
+    // Responses are small: they are sent at once rather than coalesced (fails harmlessly on Unix sockets).
+    int on = 1;
+
+    setsockopt (fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof (on));
+
+    connection *const c = connection_create (&s, fd, fd, 1);
+    pthread_t thread;
+
+    if (pthread_create (&thread, 0, connection_thread, c) || pthread_detach (thread))
+    {
+      fprintf (stderr, "Unexpected error (%s, %s, %i).\n", __func__, __FILE__, __LINE__);
+      exit (-1);
+    }
+  }
+}
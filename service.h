@@ -0,0 +1,59 @@
+/**
+ * @file
+ * Sudoku solver service, answering grids over a socket or a pipe.
+ */
+
+/***********************************************************************************
+* Author: Laurent Farhi                                                            *
+* Name: service.h                                                                  *
+* Language: C                                                                      *
+* Copyright (C) 2009, All rights reserved.                                         *
+*                                                                                  *
+* LICENSE:                                                                         *
+* This program is free software; you can redistribute it and/or modify             *
+* it under the terms of the GNU General Public License as published by             *
+* the Free Software Foundation; either version 2 of the License, or                *
+* (at your option) any later version.                                              *
+*                                                                                  *
+* This program is distributed in the hope that it will be useful,                  *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of                   *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                    *
+* GNU General Public License for more details.                                     *
+*                                                                                  *
+* You should have received a copy of the GNU General Public License                *
+* along with this program; if not, write to the Free Software                      *
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA       *
+***********************************************************************************/
+
+#pragma once
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include "solve.h"
+
+enum
+{
+  SERVICE_ID_LENGTH = 64,       ///< Maximum length of the identifiers of requests
+};
+
+/// Serves grids until the input ends (standard input) or forever (sockets).
+/// @param [in] address '-' for the standard input and output, a path (with a '/') for a Unix socket,
+/// or [host:]port for TCP (host defaulting to localhost)
+/// @param [in] method Method selected for solving the grids
+/// @param [in] find \c FIRST to find the first solution or \c ALL to find all solutions
+/// @param [in] nbThreads Number of threads solving grids, 0 for as many as online processors
+/// @param [in] cache Cache of results shared by the threads, or null
+/// @param [in] limits Limits of each resolution (see sudoku_context_limits_set()), or null
+/// @returns 0 when the standard input ends, -1 if the address can not be served (an error message is then written).
+/// @pre sudoku_init() has been called.
+///
+/// Each request is a line holding an identifier (a word of at most SERVICE_ID_LENGTH characters) followed by a grid, as
+/// in batch mode. Requests can be pipelined: they are solved by a pool of threads started once, and each response is
+/// written as soon as it is found, so that responses may come in another order than requests. A response is a line
+/// holding the identifier of the request followed by the line of batch mode for the grid, or by ERROR and a reason for
+/// an incomplete grid.
+/// Each connection is closed once its input ends and all its requests are answered.
+int service_run (const char *address, method method, findSolutions find, int nbThreads, sudoku_cache * cache,
+                 const sudoku_limits * limits);
+
+#endif
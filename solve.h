@@ -31,6 +31,69 @@
 #define SUDOKU_SOLVE_H
 #include <stdint.h>             // for uintptr_t
 
+#ifdef SUDOKU_SIZED
+// Public symbols are suffixed by the size of the grids, so that libraries built for several sizes can be linked
+// together (see solve_sized.h).
+#  if SUDOKU_SIZE == 2
+#    define SUDOKU_SYMBOL(name) name##_2
+#  elif SUDOKU_SIZE == 3 || !defined (SUDOKU_SIZE)
+#    define SUDOKU_SYMBOL(name) name##_3
+#  elif SUDOKU_SIZE == 4
+#    define SUDOKU_SYMBOL(name) name##_4
+#  elif SUDOKU_SIZE == 5
+#    define SUDOKU_SYMBOL(name) name##_5
+#  else
+#    error SUDOKU_SIZE should be between 2 and 5
+#  endif
+#  define sudoku_grid_referential SUDOKU_SYMBOL (sudoku_grid_referential)
+#  define sudoku_all_handlers_clear SUDOKU_SYMBOL (sudoku_all_handlers_clear)
+#  define sudoku_cache_counters_get SUDOKU_SYMBOL (sudoku_cache_counters_get)
+#  define sudoku_cache_create SUDOKU_SYMBOL (sudoku_cache_create)
+#  define sudoku_cache_destroy SUDOKU_SYMBOL (sudoku_cache_destroy)
+#  define sudoku_cache_set SUDOKU_SYMBOL (sudoku_cache_set)
+#  define sudoku_cancel_set SUDOKU_SYMBOL (sudoku_cancel_set)
+#  define sudoku_context_all_handlers_clear SUDOKU_SYMBOL (sudoku_context_all_handlers_clear)
+#  define sudoku_context_cache_set SUDOKU_SYMBOL (sudoku_context_cache_set)
+#  define sudoku_context_cancel_set SUDOKU_SYMBOL (sudoku_context_cancel_set)
+#  define sudoku_context_create SUDOKU_SYMBOL (sudoku_context_create)
+#  define sudoku_context_destroy SUDOKU_SYMBOL (sudoku_context_destroy)
+#  define sudoku_context_grid_event_handler_add SUDOKU_SYMBOL (sudoku_context_grid_event_handler_add)
+#  define sudoku_context_grid_event_handler_remove SUDOKU_SYMBOL (sudoku_context_grid_event_handler_remove)
+#  define sudoku_context_grid_view_handler_add SUDOKU_SYMBOL (sudoku_context_grid_view_handler_add)
+#  define sudoku_context_grid_view_handler_remove SUDOKU_SYMBOL (sudoku_context_grid_view_handler_remove)
+#  define sudoku_context_limits_set SUDOKU_SYMBOL (sudoku_context_limits_set)
+#  define sudoku_context_message_handler_add SUDOKU_SYMBOL (sudoku_context_message_handler_add)
+#  define sudoku_context_message_handler_remove SUDOKU_SYMBOL (sudoku_context_message_handler_remove)
+#  define sudoku_context_parallel_depth_set SUDOKU_SYMBOL (sudoku_context_parallel_depth_set)
+#  define sudoku_context_profile_get SUDOKU_SYMBOL (sudoku_context_profile_get)
+#  define sudoku_context_schedule_set SUDOKU_SYMBOL (sudoku_context_schedule_set)
+#  define sudoku_context_subset_depth_set SUDOKU_SYMBOL (sudoku_context_subset_depth_set)
+#  define sudoku_generate_batch SUDOKU_SYMBOL (sudoku_generate_batch)
+#  define sudoku_get_version SUDOKU_SYMBOL (sudoku_get_version)
+#  define sudoku_grid_event_handler_add SUDOKU_SYMBOL (sudoku_grid_event_handler_add)
+#  define sudoku_grid_event_handler_remove SUDOKU_SYMBOL (sudoku_grid_event_handler_remove)
+#  define sudoku_grid_view_candidates SUDOKU_SYMBOL (sudoku_grid_view_candidates)
+#  define sudoku_grid_view_handler_add SUDOKU_SYMBOL (sudoku_grid_view_handler_add)
+#  define sudoku_grid_view_handler_remove SUDOKU_SYMBOL (sudoku_grid_view_handler_remove)
+#  define sudoku_grid_view_nb_cells SUDOKU_SYMBOL (sudoku_grid_view_nb_cells)
+#  define sudoku_grid_view_value SUDOKU_SYMBOL (sudoku_grid_view_value)
+#  define sudoku_init SUDOKU_SYMBOL (sudoku_init)
+#  define sudoku_limits_set SUDOKU_SYMBOL (sudoku_limits_set)
+#  define sudoku_message_handler_add SUDOKU_SYMBOL (sudoku_message_handler_add)
+#  define sudoku_message_handler_remove SUDOKU_SYMBOL (sudoku_message_handler_remove)
+#  define sudoku_parallel_depth_set SUDOKU_SYMBOL (sudoku_parallel_depth_set)
+#  define sudoku_profile_get SUDOKU_SYMBOL (sudoku_profile_get)
+#  define sudoku_schedule_set SUDOKU_SYMBOL (sudoku_schedule_set)
+#  define sudoku_solve SUDOKU_SYMBOL (sudoku_solve)
+#  define sudoku_solve_array SUDOKU_SYMBOL (sudoku_solve_array)
+#  define sudoku_solve_batch SUDOKU_SYMBOL (sudoku_solve_batch)
+#  define sudoku_solve_ctx SUDOKU_SYMBOL (sudoku_solve_ctx)
+#  define sudoku_solve_ctx_n SUDOKU_SYMBOL (sudoku_solve_ctx_n)
+#  define sudoku_solve_n SUDOKU_SYMBOL (sudoku_solve_n)
+#  define sudoku_solve_result SUDOKU_SYMBOL (sudoku_solve_result)
+#  define sudoku_subset_depth_set SUDOKU_SYMBOL (sudoku_subset_depth_set)
+#endif
+
 const char *sudoku_get_version ();
 
 /// Types of events
@@ -88,6 +151,44 @@ void sudoku_grid_event_handler_add (sudokuGridEventType event_type, sudoku_grid_
 /// @param [in] handler Function pointer to be added.
 void sudoku_grid_event_handler_remove (sudokuGridEventType event_type, sudoku_grid_event_handler handler);
 
+/// View of the candidates of a grid, valid during the call of a view handler only.
+typedef struct sudoku_grid_view sudoku_grid_view;
+
+/// Type definition for callback functions called on events, with a view of the grid.
+///
+/// Contrary to #sudoku_grid_event_handler, no copy of the grid is made: the handler reads what it needs
+/// through the accessors below.
+typedef void (*sudoku_grid_view_handler) (uintptr_t, const sudoku_grid_view *);
+
+/// Gets the candidates of a cell of a grid.
+/// @param [in] view View of the grid
+/// @param [in] row Row of the cell (from 0)
+/// @param [in] column Column of the cell (from 0)
+/// @returns Bit mask of the possible values of the cell (bit v-1 set if value v is possible), 0 if unknown.
+unsigned int sudoku_grid_view_candidates (const sudoku_grid_view * view, int row, int column);
+
+/// Gets the value of a cell of a grid.
+/// @param [in] view View of the grid
+/// @param [in] row Row of the cell (from 0)
+/// @param [in] column Column of the cell (from 0)
+/// @returns The value of the cell, 0 if the value of the cell has not been found.
+int sudoku_grid_view_value (const sudoku_grid_view * view, int row, int column);
+
+/// Gets the number of non empty cells of a grid.
+/// @param [in] view View of the grid
+/// @returns The number of cells for which the possible value has been found.
+int sudoku_grid_view_nb_cells (const sudoku_grid_view * view);
+
+/// Adds a callback function called on events, with a view of the grid.
+/// @param [in] event_type Types (or'ed) of event to which the function is to be added.
+/// @param [in] handler Function pointer to be added.
+void sudoku_grid_view_handler_add (sudokuGridEventType event_type, sudoku_grid_view_handler handler);
+
+/// Removes a callback function called on events, with a view of the grid.
+/// @param [in] event_type Types (or'ed) of event to which the function is to be removed.
+/// @param [in] handler Function pointer to be removed.
+void sudoku_grid_view_handler_remove (sudokuGridEventType event_type, sudoku_grid_view_handler handler);
+
 /// Type definition for messages
 typedef struct sudoku_message_args
 {
@@ -116,6 +217,7 @@ typedef enum
   EXACT_COVER,                  ///< Exact cover search using dancing links algorithm (brut force)
   ELIMINATION,                  ///< Elimination (human behavior)
   BACKTRACKING,                 ///< Brut force using backtracking
+  AUTO,                         ///< Fastest of the elimination and backtracking methods, raced on threads of their own
 } method;
 
 /// Option to search for the first or all of the possible solutions.
@@ -125,6 +227,37 @@ typedef enum
   ALL                           ///< All of the solutions
 } findSolutions;
 
+/// Outcome of the search of a resolution.
+typedef enum
+{
+  SEARCH_COMPLETE,              ///< The search ended, or found as many solutions as requested
+  SEARCH_DEADLINE,              ///< The search was stopped by the timeout of the limits of the context
+  SEARCH_BUDGET,                ///< The search was stopped by the maximum number of hypotheses of the limits
+  SEARCH_CANCELLED,             ///< The search was stopped by sudoku_context_cancel_set()
+} searchStatus;
+
+/// Outcome of the resolution of a grid.
+typedef struct sudoku_result
+{
+  method method;                ///< Method effectively used to solve the grid (#NONE if no solution was found)
+  method engine;                ///< Method which searched the solutions (the winner of the race with #AUTO)
+  int nbSolutions;              ///< Number of solutions found
+  int nbHypotheses;             ///< Number of hypotheses (elimination method) or tries (backtracking method)
+  int solution[GRID_SIZE][GRID_SIZE];   ///< First solution found, meaningful only if nbSolutions > 0
+  int depth;                    ///< Depth of the hypotheses leading to the first solution (elimination method)
+  int nbSteps;                  ///< Largest number of cells filled after a hypothesis (elimination method)
+  int nbRules;                  ///< Number of logical rules applied (elimination method)
+  int cellExclusions[GRID_SIZE];        ///< Number of rules on n cells of a region, indexed by n - 1 (elimination method)
+  int candidateExclusions[GRID_SIZE];   ///< Number of rules on n values of a region, indexed by n - 1 (elimination method)
+  int valueExclusions[GRID_SIZE];       ///< Number of rules on n rows or columns of a value, indexed by n - 1 (elimination method)
+  int regionExclusions;         ///< Number of values excluded by intersections of regions (elimination method)
+  searchStatus status;          ///< Outcome of the search: if not #SEARCH_COMPLETE, the solutions and counters are
+                                ///< those found before the search was stopped
+} sudoku_result;
+
+/// Initializes the static data of the library.
+///
+/// Initialization is done once, whatever the number of calls and the calling threads.
 void sudoku_init (void);
 
 /// Solves the sudoku grid.
@@ -133,4 +266,319 @@ void sudoku_init (void);
 /// @param [in] option option to choose to search for the first (#FIRST) or all (#ALL) of the possible solutions
 /// @returns The method effectively used to solve the grid (promoted to #BACKTRACKING if needed).
 method sudoku_solve (int startGrid[GRID_SIZE][GRID_SIZE], method selected_method, findSolutions option);
+
+/// Solves the sudoku grid and reports the outcome.
+/// @param [in] startGrid Grid to be solved
+/// @param [in] selected_method Method selected for solving the grid
+/// @param [in] option option to choose to search for the first (#FIRST) or all (#ALL) of the possible solutions
+/// @param [out] result Outcome of the resolution, ignored if null
+/// @returns The method effectively used to solve the grid (promoted to #BACKTRACKING if needed).
+method sudoku_solve_result (int startGrid[GRID_SIZE][GRID_SIZE], method selected_method, findSolutions option,
+                            sudoku_result * result);
+
+/// Solves the sudoku grid, given as an array, up to a number of solutions.
+/// @param [in] startGrid Grid to be solved, GRID_SIZE * GRID_SIZE values row by row, 0 for an empty cell
+/// @param [in] selected_method Method selected for solving the grid
+/// @param [in] limit Number of solutions after which the search stops, 0 for no limit
+/// @param [out] solution First solution found (GRID_SIZE * GRID_SIZE values), ignored if null
+/// @param [out] nbSolutions Number of solutions found, exact up to the limit, ignored if null
+/// @returns The method effectively used to solve the grid (promoted to #BACKTRACKING if needed).
+///
+/// Used by sudoku_solve_sized() to solve grids of several sizes.
+method sudoku_solve_array (int startGrid[], method selected_method, int limit, int solution[], int *nbSolutions);
+
+/// Counts the solutions of the sudoku grid, up to a limit.
+/// @param [in] startGrid Grid to be solved
+/// @param [in] selected_method Method selected for solving the grid
+/// @param [in] limit Number of solutions after which the search stops, 0 for no limit
+/// @returns The number of solutions found, exact up to the limit.
+///
+/// A limit of 2 is enough to check that a grid has a unique solution.
+int sudoku_solve_n (int startGrid[GRID_SIZE][GRID_SIZE], method selected_method, int limit);
+
+/// Solver context.
+///
+/// A context owns its handlers, scratch buffers and statistics.
+/// Distinct contexts can be used concurrently by distinct threads, once sudoku_init() has been called.
+/// The functions above which do not take any context as argument use a default context.
+typedef struct sudoku_context sudoku_context;
+
+/// Creates a solver context, without any handler.
+/// @returns The context, to be destroyed by sudoku_context_destroy().
+sudoku_context *sudoku_context_create (void);
+
+/// Destroys a solver context and its handlers.
+/// @param [in] ctx Context
+void sudoku_context_destroy (sudoku_context * ctx);
+
+/// Adds a callback function called on events of a context.
+/// @param [in] ctx Context
+/// @param [in] event_type Types (or'ed) of event to which the function is to be added.
+/// @param [in] handler Function pointer to be added.
+void sudoku_context_grid_event_handler_add (sudoku_context * ctx, sudokuGridEventType event_type,
+                                            sudoku_grid_event_handler handler);
+
+/// Removes a callback function called on events of a context.
+/// @param [in] ctx Context
+/// @param [in] event_type Types (or'ed) of event to which the function is to be removed.
+/// @param [in] handler Function pointer to be removed, 0 for all.
+void sudoku_context_grid_event_handler_remove (sudoku_context * ctx, sudokuGridEventType event_type,
+                                               sudoku_grid_event_handler handler);
+
+/// Adds a callback function called on events of a context, with a view of the grid.
+/// @param [in] ctx Context
+/// @param [in] event_type Types (or'ed) of event to which the function is to be added.
+/// @param [in] handler Function pointer to be added.
+void sudoku_context_grid_view_handler_add (sudoku_context * ctx, sudokuGridEventType event_type,
+                                           sudoku_grid_view_handler handler);
+
+/// Removes a callback function called on events of a context, with a view of the grid.
+/// @param [in] ctx Context
+/// @param [in] event_type Types (or'ed) of event to which the function is to be removed.
+/// @param [in] handler Function pointer to be removed.
+void sudoku_context_grid_view_handler_remove (sudoku_context * ctx, sudokuGridEventType event_type,
+                                              sudoku_grid_view_handler handler);
+
+/// Adds a callback function called on message of a context.
+/// @param [in] ctx Context
+/// @param [in] handler Function pointer to be added.
+void sudoku_context_message_handler_add (sudoku_context * ctx, sudoku_message_handler handler);
+
+/// Removes a callback function called on message of a context.
+/// @param [in] ctx Context
+/// @param [in] handler Function pointer to be removed, 0 for all.
+void sudoku_context_message_handler_remove (sudoku_context * ctx, sudoku_message_handler handler);
+
+/// Removes all event handlers of a context.
+/// @param [in] ctx Context
+void sudoku_context_all_handlers_clear (sudoku_context * ctx);
+
+/// Sets the number of levels of hypotheses of the elimination method explored by parallel threads.
+/// @param [in] ctx Context
+/// @param [in] depth Number of levels, 0 (default) for a sequential search
+/// @returns The previous number of levels.
+///
+/// Each hypothesis made on the first levels is explored by a thread of its own,
+/// and, when searching for the first solution, the threads stop as soon as one of them has found it.
+/// The search is sequential whenever a handler is set in the context, handlers being called from a single thread.
+int sudoku_context_parallel_depth_set (sudoku_context * ctx, int depth);
+
+/// Sets the number of levels of hypotheses of the elimination method explored by parallel threads in the default context.
+/// @param [in] depth Number of levels, 0 (default) for a sequential search
+/// @returns The previous number of levels.
+int sudoku_parallel_depth_set (int depth);
+
+/// Limits the size of the subsets of cells, values, rows or columns searched by the rules of the elimination method.
+/// @param [in] ctx Context
+/// @param [in] depth Maximum size of the subsets, 0 (default) for no limit
+/// @returns The previous maximum size.
+///
+/// Smaller subsets make each rule cheaper to search, at the cost of more hypotheses.
+int sudoku_context_subset_depth_set (sudoku_context * ctx, int depth);
+
+/// Limits the size of the subsets searched by the rules of the elimination method in the default context.
+/// @param [in] depth Maximum size of the subsets, 0 (default) for no limit
+/// @returns The previous maximum size.
+int sudoku_subset_depth_set (int depth);
+
+/// Scheduling of the rules of the elimination method by increasing cost.
+typedef struct sudoku_schedule
+{
+  int regionDepth;              ///< Maximum size of the subsets of cells or values searched in a region, 0 for no limit
+  int valueDepth;               ///< Maximum size of the subsets of rows or columns searched for a value, 0 for no limit
+  int hypothesisDepth;          ///< Size of the subsets after which a hypothesis on a cell with two candidates is
+                                ///< preferred to the search of larger subsets, 0 for never
+} sudoku_schedule;
+
+/// Applies the rules of the elimination method by increasing cost rather than in a fixed order.
+/// @param [in] ctx Context
+/// @param [in] schedule Limits of the rules and policy of hypotheses, 0 (default) for the fixed order
+///
+/// By default, all the subsets of a region are searched before the next region is looked at.
+/// With a schedule, singles (subsets of size 1) and intersections are applied first, to the whole grid, until none applies;
+/// the size of the subsets searched then grows by one as long as no rule applies and falls back to 1 as soon as one does.
+/// The limits of sudoku_context_subset_depth_set() still apply.
+void sudoku_context_schedule_set (sudoku_context * ctx, const sudoku_schedule * schedule);
+
+/// Applies the rules of the elimination method by increasing cost in the default context.
+/// @param [in] schedule Limits of the rules and policy of hypotheses, 0 (default) for the fixed order
+void sudoku_schedule_set (const sudoku_schedule * schedule);
+
+/// Limits of the resolutions of a context.
+typedef struct sudoku_limits
+{
+  double timeout;               ///< Time (in seconds) after which a resolution stops, 0 for no limit
+  long maxHypotheses;           ///< Number of hypotheses (or tries) after which a resolution stops, 0 for no limit
+} sudoku_limits;
+
+/// Limits the resolutions within a context.
+/// @param [in] ctx Context
+/// @param [in] limits Limits, 0 (default) for none
+///
+/// The limits are checked by the elimination and backtracking methods each time a hypothesis is made
+/// (the clock being read once every few hundred tries by the backtracking method).
+/// A resolution stopped by a limit returns what it found so far, with a status telling which limit stopped it.
+/// The exact cover search, run by a library which can not be interrupted, is not limited.
+void sudoku_context_limits_set (sudoku_context * ctx, const sudoku_limits * limits);
+
+/// Limits the resolutions within the default context, and those of sudoku_solve_batch().
+/// @param [in] limits Limits, 0 (default) for none
+void sudoku_limits_set (const sudoku_limits * limits);
+
+/// Cancels the resolutions within a context.
+/// @param [in] ctx Context
+/// @param [in] cancel 1 to stop the resolution in progress, if any, and the next ones, 0 to allow them again
+///
+/// This function can be called from any thread (typically while another one is solving within the context).
+/// The resolution stops at its next hypothesis, with the status #SEARCH_CANCELLED.
+/// An exact cover search is only prevented from starting.
+void sudoku_context_cancel_set (sudoku_context * ctx, int cancel);
+
+/// Cancels the resolutions within the default context, and those of sudoku_solve_batch().
+/// @param [in] cancel 1 to stop the resolutions in progress and the next ones, 0 to allow them again
+void sudoku_cancel_set (int cancel);
+
+/// Functions probed when the library is compiled with SUDOKU_PROFILE defined.
+typedef enum
+{
+  SUDOKU_PROBE_REGION_SKIM,     ///< Rules on the cells of a region (elimination method)
+  SUDOKU_PROBE_VALUE_SKIM,      ///< Rules on the rows and columns of a value (elimination method)
+  SUDOKU_PROBE_INTERSECTION_SKIM,       ///< Rules on the intersection of two regions (elimination method)
+  SUDOKU_PROBE_GRID_COPY,       ///< Copies of the grid before a hypothesis (elimination method)
+  SUDOKU_PROBE_HYPOTHESIS,      ///< Hypotheses, including the resolution of the grids they lead to (elimination method)
+  SUDOKU_NB_PROBES              ///< Number of probes
+} sudoku_probe;
+
+/// Costs of a probed function.
+typedef struct sudoku_profile
+{
+  long long calls;              ///< Number of calls
+  long long nanoseconds;        ///< Time spent
+  long long eliminated;         ///< Number of candidates eliminated
+} sudoku_profile;
+
+/// Gets the costs of the probed functions during the last resolution within a context.
+/// @param [in] ctx Context
+/// @param [out] profile Costs, indexed by #sudoku_probe
+/// @returns 1 if the library was compiled with SUDOKU_PROFILE defined, 0 otherwise (costs are then zero).
+///
+/// Costs of parallel hypotheses are summed up over threads.
+int sudoku_context_profile_get (const sudoku_context * ctx, sudoku_profile profile[SUDOKU_NB_PROBES]);
+
+/// Gets the costs of the probed functions during the last resolution within the default context.
+/// @param [out] profile Costs, indexed by #sudoku_probe
+/// @returns 1 if the library was compiled with SUDOKU_PROFILE defined, 0 otherwise (costs are then zero).
+int sudoku_profile_get (sudoku_profile profile[SUDOKU_NB_PROBES]);
+
+/// Cache of the results of resolutions, shared by the contexts it is attached to.
+///
+/// A grid is looked up under its canonical form: the grids which only differ by a relabeling of the values, a
+/// permutation of the bands, of the stacks, of the rows within a band or of the columns within a stack, or a
+/// transposition, share most often the same entry, and the solution found for one of them is mapped back to the others.
+/// The least recently used entry is evicted when the cache is full.
+typedef struct sudoku_cache sudoku_cache;
+
+/// Counters of a cache.
+typedef struct sudoku_cache_counters
+{
+  long long hits;               ///< Number of resolutions answered by the cache
+  long long misses;             ///< Number of resolutions not found in the cache
+  int nbEntries;                ///< Number of results in the cache
+  int capacity;                 ///< Maximum number of results in the cache
+} sudoku_cache_counters;
+
+/// Creates a cache of results.
+/// @param [in] capacity Maximum number of results kept in the cache
+/// @returns The cache, to be destroyed by sudoku_cache_destroy() once detached from all contexts.
+sudoku_cache *sudoku_cache_create (int capacity);
+
+/// Destroys a cache of results.
+/// @param [in] cache Cache, or null
+void sudoku_cache_destroy (sudoku_cache * cache);
+
+/// Attaches a cache of results to a context.
+/// @param [in] ctx Context
+/// @param [in] cache Cache, 0 (default) for none
+/// @returns The cache previously attached to the context.
+///
+/// The cache is looked up before each resolution within the context, for the method and the number of solutions
+/// requested, and filled after it. It is bypassed whenever a handler is set in the context, handlers being called
+/// only by actual resolutions. A cache can be attached to several contexts used concurrently.
+/// The results of the cache carry the statistics of the resolution which filled it.
+sudoku_cache *sudoku_context_cache_set (sudoku_context * ctx, sudoku_cache * cache);
+
+/// Attaches a cache of results to the default context.
+/// @param [in] cache Cache, 0 (default) for none
+/// @returns The cache previously attached to the default context.
+///
+/// The cache of the default context is also used by sudoku_solve_batch().
+sudoku_cache *sudoku_cache_set (sudoku_cache * cache);
+
+/// Gets the counters of a cache.
+/// @param [in] cache Cache
+/// @param [out] counters Counters
+void sudoku_cache_counters_get (sudoku_cache * cache, sudoku_cache_counters * counters);
+
+/// Solves the sudoku grid within a context.
+/// @param [in] ctx Context
+/// @param [in] startGrid Grid to be solved
+/// @param [in] selected_method Method selected for solving the grid
+/// @param [in] option option to choose to search for the first (#FIRST) or all (#ALL) of the possible solutions
+/// @param [out] result Outcome of the resolution, ignored if null
+/// @returns The method effectively used to solve the grid (promoted to #BACKTRACKING if needed).
+/// @pre sudoku_init() has been called.
+method sudoku_solve_ctx (sudoku_context * ctx, int startGrid[GRID_SIZE][GRID_SIZE], method selected_method,
+                         findSolutions option, sudoku_result * result);
+
+/// Solves the sudoku grid within a context, up to a number of solutions.
+/// @param [in] ctx Context
+/// @param [in] startGrid Grid to be solved
+/// @param [in] selected_method Method selected for solving the grid
+/// @param [in] limit Number of solutions after which the search stops, 0 for no limit
+/// @param [out] result Outcome of the resolution, ignored if null
+/// @returns The method effectively used to solve the grid (promoted to #BACKTRACKING if needed).
+/// @pre sudoku_init() has been called.
+method sudoku_solve_ctx_n (sudoku_context * ctx, int startGrid[GRID_SIZE][GRID_SIZE], method selected_method,
+                           int limit, sudoku_result * result);
+
+/// Solves grids in parallel.
+/// @param [in] grids Grids to be solved
+/// @param [in] nbGrids Number of grids
+/// @param [in] selected_method Method selected for solving the grids
+/// @param [in] option option to choose to search for the first (#FIRST) or all (#ALL) of the possible solutions
+/// @param [in] nbThreads Number of threads to use (the calling thread included), 0 for as many as online processors
+/// @param [out] results Outcomes of the resolutions, in the order of the grids (array of nbGrids elements)
+/// @returns The number of grids for which a solution was found.
+///
+/// The grids are solved without any handler, by a pool of threads which share the load by work-stealing,
+/// through the cache of the default context if any (see sudoku_cache_set()), within the limits of the default context
+/// (see sudoku_limits_set() and sudoku_cancel_set()).
+/// With the elimination method (or #AUTO) and grids up to 16x16, singles are first propagated in lockstep in groups of
+/// grids packed in the lanes of vectors: the grids this completes or invalidates are answered as the elimination method
+/// would (without hypothesis, the counters of the rules being left to zero), and only the others are solved by the
+/// method selected.
+int sudoku_solve_batch (int grids[][GRID_SIZE][GRID_SIZE], int nbGrids, method selected_method, findSolutions option,
+                        int nbThreads, sudoku_result results[]);
+
+/// Puzzle generated by sudoku_generate_batch().
+typedef struct sudoku_puzzle
+{
+  int grid[GRID_SIZE][GRID_SIZE];       ///< Puzzle, with a unique solution and minimal (none of its givens can be removed)
+  int nbGivens;                 ///< Number of givens of the puzzle
+  int grade;                    ///< Difficulty of the puzzle, 0 if not graded (see sudoku_generate_batch())
+  sudoku_result result;         ///< Outcome of the resolution of the puzzle by elimination, meaningful only if graded
+} sudoku_puzzle;
+
+/// Generates puzzles in parallel.
+/// @param [out] puzzles Puzzles generated (array of nbPuzzles elements)
+/// @param [in] nbPuzzles Number of puzzles to generate
+/// @param [in] seed Seed of the pseudo-random generator: the same seed always gives the same puzzles
+/// @param [in] grade Non-zero to grade the puzzles by solving them with the elimination method
+/// @param [in] nbThreads Number of threads to use (the calling thread included), 0 for as many as online processors
+/// @returns The number of puzzles generated.
+///
+/// The grade of a puzzle is the size of the largest subset searched by the logical rules which excluded candidates
+/// (1 for singles only, at least 2 if intersections were needed), or GRID_SIZE plus the number of hypotheses made
+/// if the logical rules were not enough.
+int sudoku_generate_batch (sudoku_puzzle puzzles[], int nbPuzzles, unsigned long seed, int grade, int nbThreads);
 #endif
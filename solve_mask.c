@@ -164,6 +164,7 @@
 * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA       *
 ***********************************************************************************/
 
+#define _DEFAULT_SOURCE
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
@@ -174,6 +175,10 @@
 #include "finally.h"
 #include <libintl.h>
 #include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <time.h>
 
 #ifdef __USE_GNU_GETTEXT
 // Internationalization
@@ -191,6 +196,13 @@
 /// Maximum length of messages to be displayed.
 #define SUDOKU_MAX_MESSAGE_LENGTH 10001
 
+/// Bit mask of the possible values of a cell, amongst GRID_SIZE, kept as narrow as possible for the grid to be dense.
+#if SUDOKU_SIZE <= 4
+typedef uint16_t mask;
+#else
+typedef uint32_t mask;
+#endif
+
 /// Append text to the end of a string.
 /// @param [in] str String to be appended.
 /// @param [in] size Maximum length of the string.
@@ -218,29 +230,139 @@ strnadd (rule, sizeof(rule) / sizeof(*rule), __VA_ARGS__)
 /// Definition of a list event handlers.
 typedef struct sudoku_grid_event_handler_list
 {
-  sudoku_grid_event_handler handler;    ///< Function pointer
+  sudoku_grid_event_handler handler;    ///< Function pointer, or null for a view handler
+  sudoku_grid_view_handler view;        ///< Function pointer of a view handler, or null
   struct sudoku_grid_event_handler_list *next;  ///< Pointer to the next element of the list
 } sudoku_grid_event_handler_list;
 
-/// Handlers to be called on grid initialization.
-static sudoku_grid_event_handler_list *sudokuOnInitEventHandlers = 0;
+/// Definition of message handlers.
+typedef struct sudoku_message_handler_list
+{
+  sudoku_message_handler handler;       ///< Pointer to handler function
+  struct sudoku_message_handler_list *next;     ///< Pointer to the next element of the list.
+} sudoku_message_handler_list;
+
+/// Filling of a cell, recorded for the messages of the solver.
+typedef struct
+{
+  unsigned short cell;          ///< Index of the cell
+  unsigned char value;          ///< Value of the cell, from 1 to GRID_SIZE, or 0 if not recorded
+  unsigned char hypothesis;     ///< 1 if the value is a hypothesis
+} step;
+
+/// Level of the explicit stack of the search of the elimination method.
+typedef struct search_level search_level;
+
+/// Definition of counters for statistic purposes.
+typedef struct
+{
+  sudoku_context *ctx;          ///< Context of the resolution
+  int nbSolutions;              ///< Number of solutions found
+  int nbRules;                  ///< Number of rules
+  int backtrackingTries;        ///< Number of backtracking hypothesis
+  int backtrackingLevel;        ///< Backtracking depth
+  int backtrackingSteps;        ///< Backtracking depth
+  int rC[GRID_SIZE];            ///< Number of candidate exclusion per depth
+  int rV[GRID_SIZE];            ///< Number of value exclusion per depth
+  int rR[GRID_SIZE];            ///< Number of region exclusion per depth
+  int rI;                       ///< Number of intersection exclusion
+  step steps[GRID_SIZE * GRID_SIZE];    ///< Cells filled so far, in order, recorded only if messages are handled
+  int solution[GRID_SIZE][GRID_SIZE];   ///< First solution found
+  uintptr_t gridId;             ///< Identifier of the grid
+  char given[GRID_SIZE * GRID_SIZE];    ///< Flags indicating the cells initially set
+  unsigned int subsetDepth;     ///< Maximum size of the subsets searched by the rules
+  int tiered;                   ///< 1 if the rules are applied by increasing cost, following schedule
+  sudoku_schedule schedule;     ///< Limits of the rules applied by increasing cost, within subsetDepth
+  int parallelDepth;            ///< Number of levels of hypotheses still to be explored by parallel threads
+  atomic_int *found;            ///< Number of solutions found by the parallel threads, or null
+  int limit;                    ///< Number of solutions after which the search stops, 0 for no limit
+  const atomic_int *cancel;     ///< Flag raised to stop the search, or null
+  const atomic_int *cancelled;  ///< Flag raised by sudoku_context_cancel_set() to stop the search, or null
+  long maxTries;                ///< Number of hypotheses after which the search stops, 0 for no limit
+  long long deadline;           ///< Time (monotonic, in nanoseconds) after which the search stops, 0 for no limit
+  unsigned int clockPeriod;     ///< Checks of the limits between two reads of the clock, minus 1 (a power of 2 minus 1)
+  unsigned int nbChecks;        ///< Number of checks of the limits
+  searchStatus status;          ///< Outcome of the search, recording the first limit reached
+  method engine;                ///< Method searching the solutions
+  search_level *stack;          ///< Explicit stack of the search of the elimination method
+#ifdef SUDOKU_PROFILE
+  sudoku_profile profile[SUDOKU_NB_PROBES];     ///< Costs of the probed functions
+#endif
+} counters;
+
+/// Definition of a solver context.
+///
+/// Everything a resolution writes to lies in its context,
+/// the lookup tables initialized by sudoku_init() being only read afterwards.
+struct sudoku_context
+{
+  sudoku_grid_event_handler_list *sudokuOnInitEventHandlers;    ///< Handlers to be called on grid initialization.
+  sudoku_grid_event_handler_list *sudokuOnChangeEventHandlers;  ///< Handlers to be called on grid change.
+  sudoku_grid_event_handler_list *sudokuOnSolvedEventHandlers;  ///< Handlers to be called on grid solved.
+  sudoku_message_handler_list *sudokuOnMessageHandlers; ///< Handlers to be called on message.
+  counters stats;               ///< Statistic data of the current (or last) resolution
+  char values[GRID_SIZE * 2];   ///< Buffer of the string returned by VALUES()
+  int parallelDepth;            ///< Number of levels of hypotheses explored by parallel threads
+  int subsetDepth;              ///< Maximum size of the subsets searched by the rules, 0 for no limit
+  int tiered;                   ///< 1 if the rules are applied by increasing cost
+  sudoku_schedule schedule;     ///< Limits of the rules and policy of hypotheses, if tiered
+  const atomic_int *cancel;     ///< Flag raised to stop the resolutions, or null
+  sudoku_limits limits;         ///< Limits of the resolutions
+  atomic_int cancelled;         ///< Flag raised by sudoku_context_cancel_set()
+  const atomic_int *interrupt;  ///< Flag checked in place of cancelled (that of the context it derives from), or null
+  search_level *stack;          ///< Explicit stack of the elimination method, allocated on first use and reused
+  sudoku_cache *cache;          ///< Cache of results, or null
+  struct race *race;            ///< Engines raced by the method AUTO, created on first use and reused
+};
+
+static void race_destroy (struct race *r);
 
-/// Handlers to be called on grid change.
-static sudoku_grid_event_handler_list *sudokuOnChangeEventHandlers = 0;
+/// Context used by the interface functions which do not take any context as argument.
+static sudoku_context sudokuDefaultContext;
 
-/// Handlers to be called on grid solved.
-static sudoku_grid_event_handler_list *sudokuOnSolvedEventHandlers = 0;
+static void sudoku_names_init (void);
+
+sudoku_context *
+sudoku_context_create (void)
+{
+  sudoku_context *const ctx = calloc (1, sizeof (*ctx));
+
+  if (ctx == 0)
+  {
+    fprintf (stderr, _("Memory allocation error (%s, %s, %i)\n"), __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+  return ctx;
+}
 
 void
-sudoku_grid_event_handler_add (sudokuGridEventType type, sudoku_grid_event_handler handler)
+sudoku_context_destroy (sudoku_context * ctx)
+{
+  if (!ctx || ctx == &sudokuDefaultContext)
+    return;
+
+  sudoku_context_all_handlers_clear (ctx);
+  race_destroy (ctx->race);
+  free (ctx->stack);
+  free (ctx);
+}
+
+/// Add handler to the lists of handlers.
+/// @param [in] ctx Context
+/// @param [in] type Types (or'ed) of handler to add.
+/// @param [in] handler Handler to be added, or null.
+/// @param [in] view View handler to be added, if handler is null.
+static void
+grid_handler_add (sudoku_context * ctx, sudokuGridEventType type, sudoku_grid_event_handler handler,
+                  sudoku_grid_view_handler view)
 {
   sudokuGridEventType t[3] = { ON_INIT, ON_CHANGE, ON_SOLVED };
-  sudoku_grid_event_handler_list *const hls[3] =
-    { sudokuOnInitEventHandlers, sudokuOnChangeEventHandlers, sudokuOnSolvedEventHandlers };
+  sudoku_grid_event_handler_list **const hls[3] =
+    { &ctx->sudokuOnInitEventHandlers, &ctx->sudokuOnChangeEventHandlers, &ctx->sudokuOnSolvedEventHandlers };
   for (int i = 0; i < 3; i++)
   {
-    for (sudoku_grid_event_handler_list * ptr = hls[i]; ptr; ptr = ptr->next)
-      if (ptr->handler == handler)      // handler already registered
+    for (sudoku_grid_event_handler_list * ptr = *hls[i]; ptr; ptr = ptr->next)
+      if (ptr->handler == handler && ptr->view == view) // handler already registered
         t[i] = 0;
 
     if (type & t[i])
@@ -253,29 +375,17 @@ sudoku_grid_event_handler_add (sudokuGridEventType type, sudoku_grid_event_handl
         exit (-1);
       }
       pev->handler = handler;
+      pev->view = view;
       pev->next = 0;
 
-      if (hls[i] == 0)
-      {
-        switch (t[i])
-        {
-          case ON_INIT:
-            sudokuOnInitEventHandlers = pev;
-            break;
-          case ON_CHANGE:
-            sudokuOnChangeEventHandlers = pev;
-            break;
-          case ON_SOLVED:
-            sudokuOnSolvedEventHandlers = pev;
-            break;
-        }
-      }
+      if (*hls[i] == 0)
+        *hls[i] = pev;
       else
       {
         sudoku_grid_event_handler_list *ptr;
 
-        for (ptr = hls[i]; ptr->next != 0; ptr = ptr->next)
-          if (ptr->handler == handler || ptr->next->handler == handler) // handler already registered
+        for (ptr = *hls[i]; ptr->next != 0; ptr = ptr->next)
+          if ((ptr->handler == handler && ptr->view == view) || (ptr->next->handler == handler && ptr->next->view == view))     // handler already registered
           {
             free (pev);
             return;
@@ -286,15 +396,46 @@ sudoku_grid_event_handler_add (sudokuGridEventType type, sudoku_grid_event_handl
   }
 }
 
+void
+sudoku_context_grid_event_handler_add (sudoku_context * ctx, sudokuGridEventType type,
+                                       sudoku_grid_event_handler handler)
+{
+  if (handler)
+    grid_handler_add (ctx, type, handler, 0);
+}
+
+void
+sudoku_context_grid_view_handler_add (sudoku_context * ctx, sudokuGridEventType type,
+                                      sudoku_grid_view_handler handler)
+{
+  if (handler)
+    grid_handler_add (ctx, type, 0, handler);
+}
+
+void
+sudoku_grid_event_handler_add (sudokuGridEventType type, sudoku_grid_event_handler handler)
+{
+  sudoku_context_grid_event_handler_add (&sudokuDefaultContext, type, handler);
+}
+
+void
+sudoku_grid_view_handler_add (sudokuGridEventType type, sudoku_grid_view_handler handler)
+{
+  sudoku_context_grid_view_handler_add (&sudokuDefaultContext, type, handler);
+}
+
 /// Remove handler from the lists of handlers.
+/// @param [in] ctx Context
 /// @param [in] type Types (or'ed) of handler to remove.
-/// @param [in] handler Handler to be removed. 0 will remove all handlers.
-void
-sudoku_grid_event_handler_remove (sudokuGridEventType type, sudoku_grid_event_handler handler)
+/// @param [in] handler Handler to be removed, or null.
+/// @param [in] view View handler to be removed, if handler is null. 0 for both will remove all handlers.
+static void
+grid_handler_remove (sudoku_context * ctx, sudokuGridEventType type, sudoku_grid_event_handler handler,
+                     sudoku_grid_view_handler view)
 {
   sudokuGridEventType t[3] = { ON_INIT, ON_CHANGE, ON_SOLVED };
-  sudoku_grid_event_handler_list *hls[3] =
-    { sudokuOnInitEventHandlers, sudokuOnChangeEventHandlers, sudokuOnSolvedEventHandlers };
+  sudoku_grid_event_handler_list **const hls[3] =
+    { &ctx->sudokuOnInitEventHandlers, &ctx->sudokuOnChangeEventHandlers, &ctx->sudokuOnSolvedEventHandlers };
 
   sudoku_grid_event_handler_list *ptr, *next;
 
@@ -302,31 +443,19 @@ sudoku_grid_event_handler_remove (sudokuGridEventType type, sudoku_grid_event_ha
   {
     if (type & t[i])
     {
-      if (!hls[i])
-        return;
-      while (hls[i] && (!handler || hls[i]->handler == handler))
+      if (!*hls[i])
+        continue;
+      while (*hls[i] && ((!handler && !view) || ((*hls[i])->handler == handler && (*hls[i])->view == view)))
       {
-        ptr = hls[i]->next;
-        free (hls[i]);
-        hls[i] = ptr;
-        switch (t[i])
-        {
-          case ON_INIT:
-            sudokuOnInitEventHandlers = ptr;
-            break;
-          case ON_CHANGE:
-            sudokuOnChangeEventHandlers = ptr;
-            break;
-          case ON_SOLVED:
-            sudokuOnSolvedEventHandlers = ptr;
-            break;
-        }
+        ptr = (*hls[i])->next;
+        free (*hls[i]);
+        *hls[i] = ptr;
       }
-      if (!hls[i])
-        return;
-      for (ptr = hls[i]; ptr && ptr->next;)
+      if (!*hls[i])
+        continue;
+      for (ptr = *hls[i]; ptr && ptr->next;)
       {
-        if (ptr->next->handler == handler)
+        if (ptr->next->handler == handler && ptr->next->view == view)
         {
           next = ptr->next->next;
           free (ptr->next);
@@ -339,55 +468,158 @@ sudoku_grid_event_handler_remove (sudokuGridEventType type, sudoku_grid_event_ha
   }
 }
 
-/// Call handler of type #ON_INIT.
+void
+sudoku_context_grid_event_handler_remove (sudoku_context * ctx, sudokuGridEventType type,
+                                          sudoku_grid_event_handler handler)
+{
+  grid_handler_remove (ctx, type, handler, 0);
+}
+
+void
+sudoku_context_grid_view_handler_remove (sudoku_context * ctx, sudokuGridEventType type,
+                                         sudoku_grid_view_handler handler)
+{
+  if (handler)
+    grid_handler_remove (ctx, type, 0, handler);
+}
+
+/// Remove handler from the lists of handlers.
+/// @param [in] type Types (or'ed) of handler to remove.
+/// @param [in] handler Handler to be removed. 0 will remove all handlers.
+void
+sudoku_grid_event_handler_remove (sudokuGridEventType type, sudoku_grid_event_handler handler)
+{
+  sudoku_context_grid_event_handler_remove (&sudokuDefaultContext, type, handler);
+}
+
+void
+sudoku_grid_view_handler_remove (sudokuGridEventType type, sudoku_grid_view_handler handler)
+{
+  sudoku_context_grid_view_handler_remove (&sudokuDefaultContext, type, handler);
+}
+
+/// Definition of a view of a grid.
+struct sudoku_grid_view
+{
+  const mask *candidates;       ///< Bit masks of possible values of the cells, row by row, or null
+  int (*values)[GRID_SIZE];     ///< Values of the cells (0 for an empty cell), if candidates is null
+  int nbCells;                  ///< Number of non empty cells
+};
+
+unsigned int
+sudoku_grid_view_candidates (const sudoku_grid_view * view, int row, int column)
+{
+  if (view->candidates)
+    return view->candidates[row * GRID_SIZE + column];
+  else
+    return view->values[row][column] ? 1U << (view->values[row][column] - 1) : 0;
+}
+
+int
+sudoku_grid_view_value (const sudoku_grid_view * view, int row, int column)
+{
+  unsigned int bits = sudoku_grid_view_candidates (view, row, column);
+
+  return bits && !(bits & (bits - 1)) ? __builtin_ctz (bits) + 1 : 0;
+}
+
+int
+sudoku_grid_view_nb_cells (const sudoku_grid_view * view)
+{
+  return view->nbCells;
+}
+
+/// Constructs event arguments for handler.
+/// @param[in] view View of the grid
+/// @returns event argument.
+static sudoku_grid_event_args
+get_event_args (const sudoku_grid_view * view)
+{
+  sudoku_grid_event_args sudokuOnEventArgs;
+
+  for (int r = 0; r < GRID_SIZE; r++)
+    for (int c = 0; c < GRID_SIZE; c++)
+      if (view->candidates)     // candidates in place
+        for (int v = 0; v < GRID_SIZE; v++)
+          if (view->candidates[r * GRID_SIZE + c] & (1 << v))
+            sudokuOnEventArgs.grid[r][c][v] = v + 1;
+          else
+            sudokuOnEventArgs.grid[r][c][v] = 0;
+      else                      // value first
+      {
+        sudokuOnEventArgs.grid[r][c][0] = view->values[r][c];
+        for (int v = 1; v < GRID_SIZE; v++)
+          sudokuOnEventArgs.grid[r][c][v] = 0;
+      }
+
+  sudokuOnEventArgs.nbCells = view->nbCells;
+
+  return (sudokuOnEventArgs);
+}
+
+/// Call handlers of a list.
+/// @param [in] hl List of handlers
 /// @param [in] id Game identifier.
-/// @param [in] evt_args Event arguments.
+/// @param [in] view View of the grid, from which the event arguments are built if needed only.
 static void
-sudoku_on_init (uintptr_t id, sudoku_grid_event_args evt_args)
+sudoku_on_event (sudoku_grid_event_handler_list * hl, uintptr_t id, sudoku_grid_view view)
 {
-  for (sudoku_grid_event_handler_list * ptr = sudokuOnInitEventHandlers; ptr != 0; ptr = ptr->next)
-    if (ptr->handler)
+  sudoku_grid_event_args evt_args;
+  int evt_args_set = 0;
+
+  for (sudoku_grid_event_handler_list * ptr = hl; ptr != 0; ptr = ptr->next)
+    if (ptr->view)
+      (ptr->view) (id, &view);
+    else if (ptr->handler)
+    {
+      if (!evt_args_set)
+      {
+        evt_args = get_event_args (&view);
+        evt_args_set = 1;
+      }
       (ptr->handler) (id, evt_args);
+    }
 }
 
-/// Call handler of type #ON_CHANGE.
+/// Call handler of type #ON_INIT.
+/// @param [in] ctx Context
 /// @param [in] id Game identifier.
-/// @param [in] evt_args Event arguments.
+/// @param [in] view View of the grid.
 static void
-sudoku_on_change (uintptr_t id, sudoku_grid_event_args evt_args)
+sudoku_on_init (sudoku_context * ctx, uintptr_t id, sudoku_grid_view view)
 {
-  for (sudoku_grid_event_handler_list * ptr = sudokuOnChangeEventHandlers; ptr != 0; ptr = ptr->next)
-    if (ptr->handler)
-      (ptr->handler) (id, evt_args);
+  sudoku_on_event (ctx->sudokuOnInitEventHandlers, id, view);
 }
 
-/// Call handler of type #ON_SOLVED.
+/// Call handler of type #ON_CHANGE.
+/// @param [in] ctx Context
 /// @param [in] id Game identifier.
-/// @param [in] evt_args Event arguments.
+/// @param [in] view View of the grid.
 static void
-sudoku_on_solved (uintptr_t id, sudoku_grid_event_args evt_args)
+sudoku_on_change (sudoku_context * ctx, uintptr_t id, sudoku_grid_view view)
 {
-  for (sudoku_grid_event_handler_list * ptr = sudokuOnSolvedEventHandlers; ptr != 0; ptr = ptr->next)
-    if (ptr->handler)
-      (ptr->handler) (id, evt_args);
+  sudoku_on_event (ctx->sudokuOnChangeEventHandlers, id, view);
 }
 
-/// Definition of message handlers.
-typedef struct sudoku_message_handler_list
+/// Call handler of type #ON_SOLVED.
+/// @param [in] ctx Context
+/// @param [in] id Game identifier.
+/// @param [in] view View of the grid.
+static void
+sudoku_on_solved (sudoku_context * ctx, uintptr_t id, sudoku_grid_view view)
 {
-  sudoku_message_handler handler;       ///< Pointer to handler function
-  struct sudoku_message_handler_list *next;     ///< Pointer to the next element of the list.
-} sudoku_message_handler_list;
-
-/// Handlers to be called on message.
-static sudoku_message_handler_list *sudokuOnMessageHandlers;
+  sudoku_on_event (ctx->sudokuOnSolvedEventHandlers, id, view);
+}
 
 /// Add handler to the lists of handlers.
+/// @param [in] ctx Context
 /// @param [in] handler Handler to be added.
 void
-sudoku_message_handler_add (sudoku_message_handler handler)
+sudoku_context_message_handler_add (sudoku_context * ctx, sudoku_message_handler handler)
 {
-  for (sudoku_message_handler_list * ptr = sudokuOnMessageHandlers; ptr; ptr = ptr->next)
+  sudoku_names_init ();
+
+  for (sudoku_message_handler_list * ptr = ctx->sudokuOnMessageHandlers; ptr; ptr = ptr->next)
     if (ptr->handler == handler)        // handler already registered
       return;
 
@@ -401,36 +633,45 @@ sudoku_message_handler_add (sudoku_message_handler handler)
   pev->handler = handler;
   pev->next = 0;
 
-  if (sudokuOnMessageHandlers == 0)
-    sudokuOnMessageHandlers = pev;
+  if (ctx->sudokuOnMessageHandlers == 0)
+    ctx->sudokuOnMessageHandlers = pev;
   else
   {
     sudoku_message_handler_list *ptr;
 
-    for (ptr = sudokuOnMessageHandlers; ptr->next != 0; ptr = ptr->next)
+    for (ptr = ctx->sudokuOnMessageHandlers; ptr->next != 0; ptr = ptr->next)
       /* nothing */ ;
     ptr->next = pev;
   }
 }
 
+/// Add handler to the lists of handlers.
+/// @param [in] handler Handler to be added.
+void
+sudoku_message_handler_add (sudoku_message_handler handler)
+{
+  sudoku_context_message_handler_add (&sudokuDefaultContext, handler);
+}
+
 /// Remove handler to the lists of handlers.
+/// @param [in] ctx Context
 /// @param[in] handler Handler to be removed.
 void
-sudoku_message_handler_remove (sudoku_message_handler handler)
+sudoku_context_message_handler_remove (sudoku_context * ctx, sudoku_message_handler handler)
 {
   sudoku_message_handler_list *ptr, *next;
 
-  if (!sudokuOnMessageHandlers)
+  if (!ctx->sudokuOnMessageHandlers)
     return;
-  while (sudokuOnMessageHandlers && (!handler || sudokuOnMessageHandlers->handler == handler))
+  while (ctx->sudokuOnMessageHandlers && (!handler || ctx->sudokuOnMessageHandlers->handler == handler))
   {
-    ptr = sudokuOnMessageHandlers->next;
-    free (sudokuOnMessageHandlers);
-    sudokuOnMessageHandlers = ptr;
+    ptr = ctx->sudokuOnMessageHandlers->next;
+    free (ctx->sudokuOnMessageHandlers);
+    ctx->sudokuOnMessageHandlers = ptr;
   }
-  if (!sudokuOnMessageHandlers)
+  if (!ctx->sudokuOnMessageHandlers)
     return;
-  for (ptr = sudokuOnMessageHandlers; ptr && ptr->next;)
+  for (ptr = ctx->sudokuOnMessageHandlers; ptr && ptr->next;)
   {
     if (ptr->next->handler == handler)
     {
@@ -443,15 +684,24 @@ sudoku_message_handler_remove (sudoku_message_handler handler)
   }
 }
 
+/// Remove handler to the lists of handlers.
+/// @param[in] handler Handler to be removed.
+void
+sudoku_message_handler_remove (sudoku_message_handler handler)
+{
+  sudoku_context_message_handler_remove (&sudokuDefaultContext, handler);
+}
+
 /// Call handler on message.
+/// @param[in] ctx Context
 /// @param[in] id Game identifier.
 /// @param[in] evt_args Event arguments.
 static void
-sudoku_on_message (uintptr_t id, sudoku_message_args evt_args)
+sudoku_on_message (sudoku_context * ctx, uintptr_t id, sudoku_message_args evt_args)
 {
-  sudoku_message_handler_list *ptr = sudokuOnMessageHandlers;
+  sudoku_message_handler_list *ptr;
 
-  for (ptr = sudokuOnMessageHandlers; ptr != 0; ptr = ptr->next)
+  for (ptr = ctx->sudokuOnMessageHandlers; ptr != 0; ptr = ptr->next)
     if (ptr->handler)
       (ptr->handler) (id, evt_args);
 }
@@ -470,12 +720,120 @@ get_message_args (const char *message, int verbosity)
   return (sudokuMessageArgs);
 }
 
+/// Clear all event handlers
+/// @param [in] ctx Context
+void
+sudoku_context_all_handlers_clear (sudoku_context * ctx)
+{
+  sudoku_context_grid_event_handler_remove (ctx, ON_INIT | ON_CHANGE | ON_SOLVED, 0);
+  sudoku_context_message_handler_remove (ctx, 0);
+}
+
 /// Clear all event handlers
 void
 sudoku_all_handlers_clear (void)
 {
-  sudoku_grid_event_handler_remove (ON_INIT | ON_CHANGE | ON_SOLVED, 0);
-  sudoku_message_handler_remove (0);
+  sudoku_context_all_handlers_clear (&sudokuDefaultContext);
+}
+
+int
+sudoku_context_parallel_depth_set (sudoku_context * ctx, int depth)
+{
+  int old = ctx->parallelDepth;
+
+  ctx->parallelDepth = depth < 0 ? 0 : depth;
+  return old;
+}
+
+int
+sudoku_parallel_depth_set (int depth)
+{
+  return sudoku_context_parallel_depth_set (&sudokuDefaultContext, depth);
+}
+
+int
+sudoku_context_subset_depth_set (sudoku_context * ctx, int depth)
+{
+  int old = ctx->subsetDepth;
+
+  ctx->subsetDepth = depth < 0 ? 0 : depth;
+  return old;
+}
+
+int
+sudoku_subset_depth_set (int depth)
+{
+  return sudoku_context_subset_depth_set (&sudokuDefaultContext, depth);
+}
+
+void
+sudoku_context_schedule_set (sudoku_context * ctx, const sudoku_schedule * schedule)
+{
+  if ((ctx->tiered = schedule != 0))
+    ctx->schedule = *schedule;
+}
+
+void
+sudoku_schedule_set (const sudoku_schedule * schedule)
+{
+  sudoku_context_schedule_set (&sudokuDefaultContext, schedule);
+}
+
+void
+sudoku_context_limits_set (sudoku_context * ctx, const sudoku_limits * limits)
+{
+  ctx->limits = limits ? *limits : (sudoku_limits) { 0, 0 };
+}
+
+void
+sudoku_limits_set (const sudoku_limits * limits)
+{
+  sudoku_context_limits_set (&sudokuDefaultContext, limits);
+}
+
+void
+sudoku_context_cancel_set (sudoku_context * ctx, int cancel)
+{
+  atomic_store (&ctx->cancelled, cancel != 0);
+}
+
+void
+sudoku_cancel_set (int cancel)
+{
+  sudoku_context_cancel_set (&sudokuDefaultContext, cancel);
+}
+
+int
+sudoku_context_profile_get (const sudoku_context * ctx, sudoku_profile profile[SUDOKU_NB_PROBES])
+{
+#ifdef SUDOKU_PROFILE
+  memcpy (profile, ctx->stats.profile, sizeof (ctx->stats.profile));
+  return 1;
+#else
+  memset (profile, 0, SUDOKU_NB_PROBES * sizeof (*profile));
+  return 0;
+#endif
+}
+
+int
+sudoku_profile_get (sudoku_profile profile[SUDOKU_NB_PROBES])
+{
+  return sudoku_context_profile_get (&sudokuDefaultContext, profile);
+}
+
+sudoku_cache *
+sudoku_context_cache_set (sudoku_context * ctx, sudoku_cache * cache)
+{
+  sudoku_cache *const previous = ctx->cache;
+
+  ctx->cache = cache;
+  return previous;
+}
+
+sudoku_cache *
+sudoku_cache_set (sudoku_cache * cache)
+{
+  return sudoku_context_cache_set (&sudokuDefaultContext, cache);
 }
 
 /////////////////////////////////////////////////////////////////////////
@@ -486,12 +844,66 @@ sudoku_all_handlers_clear (void)
 ///////////////////////////////// ELIMINATION METHOD ////////////////////
 /////////////////////////////////////////////////////////////////////////
 
-/// Array of number of bits sets for the integer value of the index of array.
+/// Number of bits set in a bit pattern.
 /// @remark `unsigned int` is at least 16 bits in size
-static unsigned int NB_BITS[1 << GRID_SIZE];
+#define NB_BITS(bits) ((unsigned int) __builtin_popcount (bits))
+
+/// Enumeration of the subsets of a given size of a set of bits, in ascending order.
+typedef struct
+{
+  unsigned int set;             ///< Set of bits
+  unsigned int combination;     ///< Current combination of the bits of the set
+  unsigned int end;             ///< First combination out of the set
+  unsigned int subset;          ///< Current subset, SUBSET_END once the enumeration is over
+} subsets;
+
+/// Value of subsets.subset once the enumeration is over.
+#define SUBSET_END (~0U)
+
+/// Sets the subset of a set of bits corresponding to a combination of those bits.
+/// @param [in,out] s Enumeration
+static void
+subsets_deposit (subsets * s)
+{
+  unsigned int set = s->set;
+
+  s->subset = 0;
+  for (unsigned int comb = s->combination; comb; comb >>= 1, set &= set - 1)
+    if (comb & 1)
+      s->subset |= set & -set;  // i-th bit of the combination to the i-th bit set of the set
+}
+
+/// Starts the enumeration of the subsets of a set of bits.
+/// @param [out] s Enumeration
+/// @param [in] set Set of bits
+/// @param [in] size Size of the subsets
+static void
+subsets_first (subsets * s, unsigned int set, unsigned int size)
+{
+  s->set = set;
+  s->end = 1U << NB_BITS (set);
+  s->combination = (1U << size) - 1;
+  if (size == 0 || s->combination >= s->end)
+    s->subset = SUBSET_END;
+  else
+    subsets_deposit (s);
+}
+
+/// Moves on to the next subset, in ascending order.
+/// @param [in,out] s Enumeration
+static void
+subsets_next (subsets * s)
+{
+  // Gosper's hack: next combination with the same number of bits.
+  unsigned int lowest = s->combination & -s->combination;
+  unsigned int ripple = s->combination + lowest;
 
-static unsigned int SUBSETS[1 << GRID_SIZE];
-static unsigned int SUBSET_INDEX[GRID_SIZE + 1];
+  s->combination = (((ripple ^ s->combination) >> 2) / lowest) | ripple;
+  if (s->combination >= s->end)
+    s->subset = SUBSET_END;
+  else
+    subsets_deposit (s);
+}
 
 /// Alphabet.
 static char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
@@ -522,27 +934,14 @@ static char INTERSECTION_NAME[GRID_SIZE * SQUARE_SIZE * 2][50];
 
 const GridReferential sudoku_grid_referential = { ROW_NAME, COLUMN_NAME, VALUE_NAME, EMPTY_CELL };
 
-/// Definition of a cell.
-typedef struct
-{
-  /// Bit mask of possible values in the cell, amongst 9 (size of unsigned is at least 16 bits.)
-  unsigned int value;
-  /// Cell name
-  char name[3];
-  /// Set to 1 if the value of the cell is initially set.
-  char given;
-} cell;
+/// Names of cells.
+static char CELL_NAME[GRID_SIZE * GRID_SIZE][3];
 
-/// Definition of a region.
-typedef struct
-{
-  cell *cell[GRID_SIZE];        ///< The 9 cells of the region (row, column or square).
-  int changed;                  ///< Flag inidicating the region has been modified by application of a rule.
-  const char *name;             ///< Name of the region, for displaying purpose.
-  struct _grid *grid;           ///< owner grid
-} region;
+/// Indices of the 9 cells of the regions (rows, columns and squares), shared by all grids.
+static unsigned short REGION_CELL[GRID_SIZE * 3][GRID_SIZE];
 
-/// Definition of a segment (intersection of a square with a line or a column).
+/// Indices of the cells of the two regions of the segments (intersections of a square with a line or a column),
+/// shared by all grids.
 // An intersection (iii) between (e.g.) a square and a line
 // 'i' indicates the cells at intersection
 // '1' indicated the cells outside of the intersection in the square
@@ -554,38 +953,34 @@ typedef struct
 //
 // There as many intersections as nb_squares x nb_lines in a square + nb_squares x nb_columns in a square
 // i.e. GRID_SIZE * SQUARE_SIZE * 2
-typedef struct
-{
-  cell *r1_cell[GRID_SIZE - SQUARE_SIZE];       ///< The 6 cells of the first region
-  cell *r2_cell[GRID_SIZE - SQUARE_SIZE];       ///< The 6 cells of the second region
-  int changed;                  ///< Flag inidicating the intersection has been modified by application of a rule.
-  const char *name;             ///< Name of the intersection, for displaying purpose.
-  struct _grid *grid;           ///< owner grid
-} intersection;
+static unsigned short INTERSECTION_CELL[GRID_SIZE * SQUARE_SIZE * 2][2][GRID_SIZE - SQUARE_SIZE];
+
+/// Indices of the 3 regions (row, column and square) of each cell.
+static unsigned short CELL_REGION[GRID_SIZE * GRID_SIZE][3];
+
+/// Indices of the 4 x (SQUARE_SIZE - 1) intersections in one of the two regions of which each cell lies (outside of the
+/// intersection).
+static unsigned short CELL_INTERSECTION[GRID_SIZE * GRID_SIZE][4 * (SQUARE_SIZE - 1)];
 
 /// Definition of a grid.
-typedef struct _grid
-{
-  uintptr_t id;                 ///< Grid identifier
-  cell cell[GRID_SIZE][GRID_SIZE];      ///< 81 cells
-  intersection intersection[GRID_SIZE * SQUARE_SIZE * 2];       ///< 27 groups of 3 horizontal cells + 27 groups of 3 vertical cells
-  region region[GRID_SIZE * 3]; ///< 9 rows, 9 columns, 9 squares
-} grid;
-
-/// Definition of counters for statistic purposes.
+///
+/// A grid only holds its own state, the topology of regions and intersections lying in the tables above,
+/// so that a grid can be copied as a plain structure.
 typedef struct
 {
-  int nbSolutions;              ///< Number of solutions found
-  int nbRules;                  ///< Number of rules
-  int backtrackingTries;        ///< Number of backtracking hypothesis
-  int backtrackingLevel;        ///< Backtracking depth
-  int backtrackingSteps;        ///< Backtracking depth
-  int rC[GRID_SIZE];            ///< Number of candidate exclusion per depth
-  int rV[GRID_SIZE];            ///< Number of value exclusion per depth
-  int rR[GRID_SIZE];            ///< Number of region exclusion per depth
-  int rI;                       ///< Number of intersection exclusion
-  char theSolution[GRID_SIZE * GRID_SIZE][20];  ///< Last solution found
-} counters;
+  /// Bit masks of possible values in the 81 cells, amongst 9 (162 bytes for a 9x9 grid.)
+  mask cell[GRID_SIZE * GRID_SIZE];
+  /// Size of the subsets up to which the rules have been applied to each of the 27 regions (9 rows, 9 columns,
+  /// 9 squares) since it was last modified by application of a rule, 0 if modified.
+  unsigned char regionDepth[GRID_SIZE * 3];
+  /// Size of the subsets up to which the rules have been applied to each of the 9 values since its candidates were
+  /// last modified, 0 if modified.
+  unsigned char valueDepth[GRID_SIZE];
+  /// Flags indicating the 54 intersections (27 groups of 3 horizontal cells + 27 groups of 3 vertical cells)
+  /// have been modified by application of a rule.
+  char intersectionChanged[GRID_SIZE * SQUARE_SIZE * 2];
+  int nbFilled;                 ///< Number of cells for which the value has been found.
+} grid;
 
 /// Definition of region types.
 typedef enum                    // Fixed constant values since the enumeration may be used in arithmetics
@@ -601,23 +996,17 @@ typedef enum                    // Fixed constant values since the enumeration m
 static char
 VALUE (unsigned int bit)
 {
-  if (NB_BITS[bit] != 1)
-    return 0;
-  else
-    for (const char *d = VALUE_NAME; *d && bit; (bit >>= 1), (d++))
-      if (bit & 1)
-        return *d;
-
-  return EMPTY_CELL;
+  return NB_BITS (bit) == 1 ? VALUE_NAME[__builtin_ctz (bit)] : 0;
 }
 
 /// Converts a bit pattern into values.
+/// @param[in] ctx Context owning the returned string.
 /// @param[in] bits pattern to be converted.
-/// @return string of values.
+/// @return string of values, valid until the next call with the same context.
 static const char *
-VALUES (unsigned int bits)
+VALUES (sudoku_context * ctx, unsigned int bits)
 {
-  static char _v[GRID_SIZE * 2];
+  char *const _v = ctx->values;
   int pos = 0;
 
   for (const char *d = VALUE_NAME; *d && bits; (bits >>= 1), (d++))
@@ -634,86 +1023,90 @@ VALUES (unsigned int bits)
   return _v;
 }
 
-static int grid_cell_changed (grid *, cell *);
-static int grid_countEmptyCells (grid *);
+static int grid_cell_changed (grid *, int, unsigned int, counters *);
+
+/// Records the last filled cell of a grid, for the messages of the solver only.
+/// @param [in] g Grid
+/// @param [in] c Index of the cell, filled
+/// @param [in] hypothesis 1 if the value of the cell is a hypothesis, 0 otherwise
+/// @param [in,out] stats Statistic data
+static void
+grid_step_record (const grid * g, int c, int hypothesis, counters * stats)
+{
+  if (stats->ctx->sudokuOnMessageHandlers)
+  {
+    step *const s = &stats->steps[g->nbFilled - 1];
+
+    s->cell = c;
+    s->value = __builtin_ctz (g->cell[c]) + 1;
+    s->hypothesis = hypothesis;
+  }
+}
 
 /// Eliminates values from an intersection.
-/// @param [in,out] inter Intersection
+/// @param [in,out] g Grid
+/// @param [in] ii Index of the intersection
 /// @param [in,out] stats Statistic data
 /// @return Number of possible values in intersection
 static int
-intersection_skim (intersection * inter, counters * stats)
+intersection_skim (grid * g, int ii, counters * stats)
 {
+  unsigned short (*const r_cell)[GRID_SIZE - SQUARE_SIZE] = INTERSECTION_CELL[ii];
   unsigned int values[2] = { 0, 0 };
   for (int i = 0; i < GRID_SIZE - SQUARE_SIZE; i++)
   {
-    values[0] |= inter->r1_cell[i]->value;
-    values[1] |= inter->r2_cell[i]->value;
+    values[0] |= g->cell[r_cell[0][i]];
+    values[1] |= g->cell[r_cell[1][i]];
   }
 
   unsigned int intersection = values[0] ^ values[1];
 
   if (intersection)
   {
-    stats->nbRules += NB_BITS[intersection];
-    stats->rI += NB_BITS[intersection];
+    stats->nbRules += NB_BITS (intersection);
+    stats->rI += NB_BITS (intersection);
 
-    if (sudokuOnMessageHandlers)
+    if (stats->ctx->sudokuOnMessageHandlers)
     {
       char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-      if (NB_BITS[intersection] > 1)
+      if (NB_BITS (intersection) > 1)
         MESSAGE_APPEND (rule,
-                        _("%s: the values (%s) can only lie in %s.\n"), inter->name, VALUES (intersection),
-                        inter->name);
+                        _("%s: the values (%s) can only lie in %s.\n"), INTERSECTION_NAME[ii],
+                        VALUES (stats->ctx, intersection), INTERSECTION_NAME[ii]);
       else
         MESSAGE_APPEND (rule,
-                        _("%s: the value (%s) can only lie in %s.\n"), inter->name, VALUES (intersection), inter->name);
+                        _("%s: the value (%s) can only lie in %s.\n"), INTERSECTION_NAME[ii],
+                        VALUES (stats->ctx, intersection), INTERSECTION_NAME[ii]);
       if (*rule)
-        sudoku_on_message (inter->grid->id, get_message_args (rule, 1));
-    }
-
-    for (int i = 0; i < GRID_SIZE - SQUARE_SIZE; i++)
-    {
-      unsigned int oldval = inter->r1_cell[i]->value;
-
-      inter->r1_cell[i]->value &= ~intersection;
-      if (oldval != inter->r1_cell[i]->value)
-        if (grid_cell_changed (inter->grid, inter->r1_cell[i]))
-        {
-          int nbCells = GRID_SIZE * GRID_SIZE - grid_countEmptyCells (inter->grid);
-
-          sprintf (stats->theSolution[nbCells - 1], "%2i. %s=%c", nbCells, inter->r1_cell[i]->name,
-                   VALUE (inter->r1_cell[i]->value));
-        }
+        sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 1));
     }
 
-    for (int i = 0; i < GRID_SIZE - SQUARE_SIZE; i++)
-    {
-      unsigned int oldval = inter->r2_cell[i]->value;
-
-      inter->r2_cell[i]->value &= ~intersection;
-      if (oldval != inter->r2_cell[i]->value)
-        if (grid_cell_changed (inter->grid, inter->r2_cell[i]))
-        {
-          int nbCells = GRID_SIZE * GRID_SIZE - grid_countEmptyCells (inter->grid);
+    for (int k = 0; k < 2; k++)
+      for (int i = 0; i < GRID_SIZE - SQUARE_SIZE; i++)
+      {
+        int c = r_cell[k][i];
+        unsigned int oldval = g->cell[c];
 
-          sprintf (stats->theSolution[nbCells - 1], "%2i. %s=%c", nbCells, inter->r2_cell[i]->name,
-                   VALUE (inter->r2_cell[i]->value));
-        }
-    }
+        g->cell[c] &= ~intersection;
+        if (oldval != g->cell[c])
+          if (grid_cell_changed (g, c, oldval, stats))
+            grid_step_record (g, c, 0, stats);
+      }
   }
 
-  return NB_BITS[intersection];
+  return NB_BITS (intersection);
 }
 
 /// Eliminates regions (rows and columns) for a value
 /// @param [in] g Grid
 /// @param [in] value Value to be removed.
+/// @param [in] minDepth Size of the smallest subsets of rows or columns searched, smaller ones being already searched
+/// @param [in] maxDepth Size of the largest subsets of rows or columns searched
 /// @param [in,out] stats Statistic data
 /// @return skimming depth
 static int
-value_skim (grid * g, unsigned int value, counters * stats)
+value_skim (grid * g, unsigned int value, unsigned int minDepth, unsigned int maxDepth, counters * stats)
 {
   unsigned int rows;
   unsigned int columns;
@@ -721,533 +1114,574 @@ value_skim (grid * g, unsigned int value, counters * stats)
 
   int stop = 0;
 
-  for (unsigned int depth = 1; depth <= GRID_SIZE && !stop; depth++)
+  // The row exclusion rule applies to subsets of rows, the column exclusion rule to subsets of columns.
+  unsigned int subsetRows = (1 << GRID_SIZE) - 1;
+  unsigned int subsetColumns = (1 << GRID_SIZE) - 1;
+  for (unsigned int depth = 1; depth <= maxDepth && !stop; depth++)
   {
-    for (unsigned int index = SUBSET_INDEX[depth - 1]; index < SUBSET_INDEX[depth]; index++)
+    if (depth == 2)
     {
-      bits = SUBSETS[index];
+      // Rules on subsets including rows (or columns) where the value is found are the rules on the same subsets
+      // deprived of them, already applied at lower depth: only the remaining rows and columns are searched beyond depth 1.
+      for (unsigned int row = 0; row < GRID_SIZE; row++)
+        for (unsigned int col = 0; col < GRID_SIZE; col++)
+          if (g->cell[row * GRID_SIZE + col] == (1U << (value - 1)))
+          {
+            subsetRows &= ~(1U << row);
+            subsetColumns &= ~(1U << col);
+          }
+
+      // A rule on n out of N remaining rows is the rule on the N-n other columns (and conversely),
+      // which would have been found at lower depth if n > N/2.
+      if (maxDepth > (NB_BITS (subsetRows) + 1) / 2)
+        maxDepth = (NB_BITS (subsetRows) + 1) / 2;
+      if (depth > maxDepth)
+        break;
+    }
 
-      ////////////////////////////////////////////
-      // row exclusion rule
-      ////////////////////////////////////////////
+    if (depth < minDepth)
+      continue;
 
-      rows = bits;
-      columns = 0;
-      for (unsigned int row = 0; row < GRID_SIZE; row++)
-      {
-        if (rows & 1)
-          for (unsigned int col = 0; col < GRID_SIZE; col++)
-            if (g->cell[row][col].value & (1 << (value - 1)))
-              columns |= (1 << col);    // columns of all cells in 'rows' of subset which contain value
-        rows >>= 1;
-      }
+    subsets s1, s2;
+
+    subsets_first (&s1, subsetRows, depth);
+    subsets_first (&s2, subsetColumns, depth);
+    while (s1.subset != SUBSET_END || s2.subset != SUBSET_END)
+    {
+      // Both enumerations are merged in ascending order.
+      bits = s1.subset < s2.subset ? s1.subset : s2.subset;
 
-      if (NB_BITS[columns] < NB_BITS[bits])
-        return (-1);            // Invalid grid
-      else if (NB_BITS[columns] == NB_BITS[bits])
+      if (bits == s1.subset)
       {
-        // other lines than thoses of 'rows' don't contain value in those 'columns'
-        unsigned int skimLevel = 0;
-        unsigned int otherrows = ~bits;
+        subsets_next (&s1);
 
+        ////////////////////////////////////////////
+        // row exclusion rule
+        ////////////////////////////////////////////
+
+        rows = bits;
+        columns = 0;
         for (unsigned int row = 0; row < GRID_SIZE; row++)
         {
-          if (otherrows & 1)
-          {
-            unsigned int cols = columns;
-
+          if (rows & 1)
             for (unsigned int col = 0; col < GRID_SIZE; col++)
+              if (g->cell[row * GRID_SIZE + col] & (1 << (value - 1)))
+                columns |= (1 << col);    // columns of all cells in 'rows' of subset which contain value
+          rows >>= 1;
+        }
+
+        if (NB_BITS (columns) < NB_BITS (bits))
+          return (-1);            // Invalid grid
+        else if (NB_BITS (columns) == NB_BITS (bits))
+        {
+          // other lines than thoses of 'rows' don't contain value in those 'columns'
+          unsigned int skimLevel = 0;
+          unsigned int otherrows = ~bits;
+
+          for (unsigned int row = 0; row < GRID_SIZE; row++)
+          {
+            if (otherrows & 1)
             {
-              if (cols & 1)
-              {
-                unsigned int oldval = g->cell[row][col].value;
+              unsigned int cols = columns;
 
-                g->cell[row][col].value &= ~(1 << (value - 1));
-                if (oldval != g->cell[row][col].value)
+              for (unsigned int col = 0; col < GRID_SIZE; col++)
+              {
+                if (cols & 1)
                 {
-                  skimLevel = NB_BITS[bits];
-                  if (grid_cell_changed (g, &g->cell[row][col]))
-                  {
-                    int nbCells = GRID_SIZE * GRID_SIZE - grid_countEmptyCells (g);
+                  unsigned int oldval = g->cell[row * GRID_SIZE + col];
 
-                    sprintf (stats->theSolution[nbCells - 1], "%2i. %s=%c", nbCells, g->cell[row][col].name,
-                             VALUE (g->cell[row][col].value));
+                  g->cell[row * GRID_SIZE + col] &= ~(1 << (value - 1));
+                  if (oldval != g->cell[row * GRID_SIZE + col])
+                  {
+                    skimLevel = NB_BITS (bits);
+                    if (grid_cell_changed (g, row * GRID_SIZE + col, oldval, stats))
+                      grid_step_record (g, row * GRID_SIZE + col, 0, stats);
+                    if (g->cell[row * GRID_SIZE + col] == 0)
+                      return (-1);        // Invalid grid
                   }
-                  if (g->cell[row][col].value == 0)
-                    return (-1);        // Invalid grid
                 }
+                cols >>= 1;
               }
-              cols >>= 1;
             }
+            otherrows >>= 1;
           }
-          otherrows >>= 1;
-        }
-        if (skimLevel)
-        {
-          if (sudokuOnMessageHandlers)
+          if (skimLevel)
           {
-            unsigned int d = 0;
-            char noprint = 0;
+            if (stats->ctx->sudokuOnMessageHandlers)
+            {
+              unsigned int d = 0;
+              char noprint = 0;
 
-            if (NB_BITS[bits] == 1)
-              for (unsigned int rows = bits; rows; rows >>= 1, d++)
-                for (unsigned int col = 0; col < GRID_SIZE; col++)
-                  if (g->cell[d][col].value & (1 << (value - 1)) && g->cell[d][col].given)
-                    noprint = 1;
+              if (NB_BITS (bits) == 1)
+                for (unsigned int rows = bits; rows; rows >>= 1, d++)
+                  for (unsigned int col = 0; col < GRID_SIZE; col++)
+                    if (g->cell[d * GRID_SIZE + col] & (1 << (value - 1)) && stats->given[d * GRID_SIZE + col])
+                      noprint = 1;
 
-            char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
+              char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-            // Display:
-            char row_names[2 * NB_BITS[bits] + 1];
-            char col_names[2 * NB_BITS[bits] + 1];
+              // Display:
+              char row_names[2 * NB_BITS (bits) + 1];
+              char col_names[2 * NB_BITS (bits) + 1];
+
+              d = 0;
+              for (unsigned int rows = bits; rows; rows >>= 1, d++)
+                if (rows & 1)
+                {
+                  row_names[2 * NB_BITS (rows) - 2] = ' ';
+                  row_names[2 * NB_BITS (rows) - 1] = ROW_NAME[d];
+                }
+              row_names[2 * NB_BITS (bits)] = '\0';
+              d = 0;
+              for (unsigned int cols = columns; cols; cols >>= 1, d++)
+                if (cols & 1)
+                {
+                  col_names[2 * NB_BITS (cols) - 2] = ' ';
+                  col_names[2 * NB_BITS (cols) - 1] = COLUMN_NAME[d];
+                }
+              col_names[2 * NB_BITS (columns)] = '\0';
 
-            d = 0;
-            for (unsigned int rows = bits; rows; rows >>= 1, d++)
-              if (rows & 1)
+              if (NB_BITS (bits) > 1)
               {
-                row_names[2 * NB_BITS[rows] - 2] = ' ';
-                row_names[2 * NB_BITS[rows] - 1] = ROW_NAME[d];
+                MESSAGE_APPEND (rule, _("Value %i in each one of the %i rows [%s] lie only in one of the columns [%s].\n\
+-> Value %i in each one of the %i columns [%s] can only lie in the rows [%s].\n"), value, NB_BITS (bits), row_names, col_names, value, NB_BITS (bits), col_names, row_names);
+
+                sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 1));
               }
-            row_names[2 * NB_BITS[bits]] = '\0';
-            d = 0;
-            for (unsigned int cols = columns; cols; cols >>= 1, d++)
-              if (cols & 1)
+              else if (!noprint)
               {
-                col_names[2 * NB_BITS[cols] - 2] = ' ';
-                col_names[2 * NB_BITS[cols] - 1] = COLUMN_NAME[d];
-              }
-            col_names[2 * NB_BITS[columns]] = '\0';
-
-            if (NB_BITS[bits] > 1)
-            {
-              MESSAGE_APPEND (rule, _("Value %i in each one of the %i rows [%s] lie only in one of the columns [%s].\n\
--> Value %i in each one of the %i columns [%s] can only lie in the rows [%s].\n"), value, NB_BITS[bits], row_names, col_names, value, NB_BITS[bits], col_names, row_names);
-
-              sudoku_on_message (g->id, get_message_args (rule, 1));
-            }
-            else if (!noprint)
-            {
-              MESSAGE_APPEND (rule, _("Value %i in row [%s] lies only in column [%s].\n\
+                MESSAGE_APPEND (rule, _("Value %i in row [%s] lies only in column [%s].\n\
 -> Value %i in column [%s] can only lie in the row [%s].\n"), value, row_names, col_names, value, col_names, row_names);
 
-              sudoku_on_message (g->id, get_message_args (rule, 3));
+                sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 3));
+              }
             }
-          }
-
-          stats->nbRules++;
-          stats->rR[skimLevel - 1]++;
-          if (skimLevel > 1)
-            return (skimLevel);
-          else
-            stop = skimLevel;
-        }                       // if (skimLevel)
-      }                         // if (NB_BITS[values] == NB_BITS[bits])
-
-      ////////////////////////////////////////////
-      // column exclusion rule
-      ////////////////////////////////////////////
 
-      columns = bits;
-      rows = 0;
-      for (unsigned int col = 0; col < GRID_SIZE; col++)
-      {
-        if (columns & 1)
-          for (unsigned int row = 0; row < GRID_SIZE; row++)
-            if (g->cell[row][col].value & (1 << (value - 1)))
-              rows |= (1 << row);       // columns of all cells in 'rows' of subset which contain value
-        columns >>= 1;
+            stats->nbRules++;
+            stats->rR[skimLevel - 1]++;
+            if (skimLevel > 1)
+              return (skimLevel);
+            else
+              stop = skimLevel;
+          }                       // if (skimLevel)
+        }                         // if (NB_BITS (values) == NB_BITS (bits))
       }
 
-      if (NB_BITS[rows] < NB_BITS[bits])
-        return (-1);            // Invalid grid
-      else if (NB_BITS[rows] == NB_BITS[bits])
+      if (bits == s2.subset)
       {
-        // other lines than thoses of 'rows' don't contain value in those 'columns'
-        unsigned int skimLevel = 0;
-        unsigned int othercols = ~bits;
+        subsets_next (&s2);
 
+        ////////////////////////////////////////////
+        // column exclusion rule
+        ////////////////////////////////////////////
+
+        columns = bits;
+        rows = 0;
         for (unsigned int col = 0; col < GRID_SIZE; col++)
         {
-          if (othercols & 1)
-          {
-            unsigned int lrows = rows;
-
+          if (columns & 1)
             for (unsigned int row = 0; row < GRID_SIZE; row++)
+              if (g->cell[row * GRID_SIZE + col] & (1 << (value - 1)))
+                rows |= (1 << row);       // columns of all cells in 'rows' of subset which contain value
+          columns >>= 1;
+        }
+
+        if (NB_BITS (rows) < NB_BITS (bits))
+          return (-1);            // Invalid grid
+        else if (NB_BITS (rows) == NB_BITS (bits))
+        {
+          // other lines than thoses of 'rows' don't contain value in those 'columns'
+          unsigned int skimLevel = 0;
+          unsigned int othercols = ~bits;
+
+          for (unsigned int col = 0; col < GRID_SIZE; col++)
+          {
+            if (othercols & 1)
             {
-              if (lrows & 1)
-              {
-                unsigned int oldval = g->cell[row][col].value;
+              unsigned int lrows = rows;
 
-                g->cell[row][col].value &= ~(1 << (value - 1));
-                if (oldval != g->cell[row][col].value)
+              for (unsigned int row = 0; row < GRID_SIZE; row++)
+              {
+                if (lrows & 1)
                 {
-                  skimLevel = NB_BITS[bits];
-                  if (grid_cell_changed (g, &g->cell[row][col]))
-                  {
-                    int nbCells = GRID_SIZE * GRID_SIZE - grid_countEmptyCells (g);
+                  unsigned int oldval = g->cell[row * GRID_SIZE + col];
 
-                    sprintf (stats->theSolution[nbCells - 1], "%2i. %s=%c", nbCells, g->cell[row][col].name,
-                             VALUE (g->cell[row][col].value));
+                  g->cell[row * GRID_SIZE + col] &= ~(1 << (value - 1));
+                  if (oldval != g->cell[row * GRID_SIZE + col])
+                  {
+                    skimLevel = NB_BITS (bits);
+                    if (grid_cell_changed (g, row * GRID_SIZE + col, oldval, stats))
+                      grid_step_record (g, row * GRID_SIZE + col, 0, stats);
+                    if (g->cell[row * GRID_SIZE + col] == 0)
+                      return (-1);        // Invalid grid
                   }
-                  if (g->cell[row][col].value == 0)
-                    return (-1);        // Invalid grid
                 }
+                lrows >>= 1;
               }
-              lrows >>= 1;
             }
+            othercols >>= 1;
           }
-          othercols >>= 1;
-        }
-        if (skimLevel)
-        {
-          if (sudokuOnMessageHandlers)
+          if (skimLevel)
           {
-            unsigned int d = 0;
-            char noprint = 0;
+            if (stats->ctx->sudokuOnMessageHandlers)
+            {
+              unsigned int d = 0;
+              char noprint = 0;
 
-            if (NB_BITS[bits] == 1)
-              for (unsigned int columns = bits; columns; columns >>= 1, d++)
-                for (unsigned int row = 0; row < GRID_SIZE; row++)
-                  if (g->cell[row][d].value & (1 << (value - 1)) && g->cell[row][d].given)
-                    noprint = 1;
+              if (NB_BITS (bits) == 1)
+                for (unsigned int columns = bits; columns; columns >>= 1, d++)
+                  for (unsigned int row = 0; row < GRID_SIZE; row++)
+                    if (g->cell[row * GRID_SIZE + d] & (1 << (value - 1)) && stats->given[row * GRID_SIZE + d])
+                      noprint = 1;
+
+              char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-            char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
+              // Display:
+              char row_names[2 * NB_BITS (bits) + 1];
+              char col_names[2 * NB_BITS (bits) + 1];
 
-            // Display:
-            char row_names[2 * NB_BITS[bits] + 1];
-            char col_names[2 * NB_BITS[bits] + 1];
+              d = 0;
+              for (unsigned int lrows = rows; lrows; lrows >>= 1, d++)
+                if (lrows & 1)
+                {
+                  row_names[2 * NB_BITS (lrows) - 2] = ' ';
+                  row_names[2 * NB_BITS (lrows) - 1] = ROW_NAME[d];
+                }
+              row_names[2 * NB_BITS (rows)] = '\0';
+              d = 0;
+              for (unsigned int cols = bits; cols; cols >>= 1, d++)
+                if (cols & 1)
+                {
+                  col_names[2 * NB_BITS (cols) - 2] = ' ';
+                  col_names[2 * NB_BITS (cols) - 1] = COLUMN_NAME[d];
+                }
+              col_names[2 * NB_BITS (bits)] = '\0';
 
-            d = 0;
-            for (unsigned int lrows = rows; lrows; lrows >>= 1, d++)
-              if (lrows & 1)
+              if (NB_BITS (bits) > 1)
               {
-                row_names[2 * NB_BITS[lrows] - 2] = ' ';
-                row_names[2 * NB_BITS[lrows] - 1] = ROW_NAME[d];
+                MESSAGE_APPEND (rule, _("Value %i in each one of the %i columns [%s] lie only in one of the rows [%s].\n\
+-> Value %i in each one of the %i rows [%s] can only lie in the columns [%s].\n"), value, NB_BITS (bits), col_names, row_names, value, NB_BITS (bits), row_names, col_names);
+
+                sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 1));
               }
-            row_names[2 * NB_BITS[rows]] = '\0';
-            d = 0;
-            for (unsigned int cols = bits; cols; cols >>= 1, d++)
-              if (cols & 1)
+              else if (!noprint)
               {
-                col_names[2 * NB_BITS[cols] - 2] = ' ';
-                col_names[2 * NB_BITS[cols] - 1] = COLUMN_NAME[d];
-              }
-            col_names[2 * NB_BITS[bits]] = '\0';
-
-            if (NB_BITS[bits] > 1)
-            {
-              MESSAGE_APPEND (rule, _("Value %i in each one of the %i columns [%s] lie only in one of the rows [%s].\n\
--> Value %i in each one of the %i rows [%s] can only lie in the columns [%s].\n"), value, NB_BITS[bits], col_names, row_names, value, NB_BITS[bits], row_names, col_names);
-
-              sudoku_on_message (g->id, get_message_args (rule, 1));
-            }
-            else if (!noprint)
-            {
-              MESSAGE_APPEND (rule, _("Value %i in column [%s] lies only in row [%s].\n\
+                MESSAGE_APPEND (rule, _("Value %i in column [%s] lies only in row [%s].\n\
 -> Value %i in row [%s] can only lie in the column [%s].\n"), value, col_names, row_names, value, row_names, col_names);
 
-              sudoku_on_message (g->id, get_message_args (rule, 3));
+                sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 3));
+              }
             }
-          }
-
-          stats->nbRules++;
-          stats->rR[skimLevel - 1]++;
-          if (skimLevel > 1)
-            return (skimLevel);
-          else
-            stop = skimLevel;
-        }                       // if (skimLevel)
-      }                         // if (NB_BITS[values] == NB_BITS[bits])
 
-    }                           // for (unsigned int index=SUBSET_INDEX[depth-1] ; index<SUBSET_INDEX[depth] ; index++)
-  }                             // for (unsigned int depth = 1 ; depth<=9 && !stop ; depth++)
+            stats->nbRules++;
+            stats->rR[skimLevel - 1]++;
+            if (skimLevel > 1)
+              return (skimLevel);
+            else
+              stop = skimLevel;
+          }                       // if (skimLevel)
+        }                         // if (NB_BITS (values) == NB_BITS (bits))
+      }
+    }                           // while (s1.subset != SUBSET_END || s2.subset != SUBSET_END)
+  }                             // for (unsigned int depth = 1 ; depth<=maxDepth && !stop ; depth++)
 
   return stop;
 }
 
 /// Eliminates values from a region.
-/// @param [in,out] reg Region
+/// @param [in,out] g Grid
+/// @param [in] ir Index of the region
+/// @param [in] minDepth Size of the smallest subsets of cells or values searched, smaller ones being already searched
+/// @param [in] maxDepth Size of the largest subsets of cells or values searched
 /// @param [in,out] stats Statistic data
 /// @return Number of possible values in region
 static int
-region_skim (region * reg, counters * stats)
+region_skim (grid * g, int ir, unsigned int minDepth, unsigned int maxDepth, counters * stats)
 {
+  const unsigned short *const r_cell = REGION_CELL[ir];
   unsigned int cells;
   unsigned int values;
   unsigned int bits;
 
   int stop = 0;
 
-  for (unsigned int depth = 1; depth <= GRID_SIZE && !stop; depth++)
+  // The candidate exclusion rule applies to subsets of cells, the value exclusion rule to subsets of values.
+  unsigned int subsetCells = (1 << GRID_SIZE) - 1;
+  unsigned int subsetValues = (1 << GRID_SIZE) - 1;
+  for (unsigned int depth = 1; depth <= maxDepth && !stop; depth++)
   {
-    for (unsigned int index = SUBSET_INDEX[depth - 1]; index < SUBSET_INDEX[depth]; index++)
+    if (depth == 2)
     {
-      bits = SUBSETS[index];
+      // Rules on subsets including filled cells (or their values) are the rules on the same subsets deprived
+      // of them, already applied at lower depth: only the remaining cells and values are searched beyond depth 1.
+      for (unsigned int cell = 0; cell < GRID_SIZE; cell++)
+        if (NB_BITS (g->cell[r_cell[cell]]) == 1)
+        {
+          subsetCells &= ~(1U << cell);
+          subsetValues &= ~g->cell[r_cell[cell]];
+        }
 
-      ////////////////////////////////////////////
-      // candidate exclusion rule
-      ////////////////////////////////////////////
+      // A rule on n out of N remaining cells is the rule on the N-n other values (and conversely),
+      // which would have been found at lower depth if n > N/2.
+      if (maxDepth > (NB_BITS (subsetCells) + 1) / 2)
+        maxDepth = (NB_BITS (subsetCells) + 1) / 2;
+      if (depth > maxDepth)
+        break;
+    }
 
-      cells = bits;
-      values = 0;
-      for (unsigned int cell = 0; cell < GRID_SIZE; cell++)
-      {
-        if (cells & 1)
-          values |= reg->cell[cell]->value;     // values of all cells in 'cells' of subset
-        cells >>= 1;
-      }
+    if (depth < minDepth)
+      continue;
+
+    subsets s1, s2;
+
+    subsets_first (&s1, subsetCells, depth);
+    subsets_first (&s2, subsetValues, depth);
+    while (s1.subset != SUBSET_END || s2.subset != SUBSET_END)
+    {
+      // Both enumerations are merged in ascending order.
+      bits = s1.subset < s2.subset ? s1.subset : s2.subset;
 
-      if (NB_BITS[values] < NB_BITS[bits])
-        return (-1);            // Invalid grid
-      else if (NB_BITS[values] == NB_BITS[bits])
+      if (bits == s1.subset)
       {
-        // cells of region other than those of 'cells' do not contain values of 'values'
-        unsigned int skimLevel = 0;
-        unsigned int othercells = ~bits;
+        subsets_next (&s1);
 
+        ////////////////////////////////////////////
+        // candidate exclusion rule
+        ////////////////////////////////////////////
+
+        cells = bits;
+        values = 0;
         for (unsigned int cell = 0; cell < GRID_SIZE; cell++)
         {
-          if (othercells & 1)
-          {
-            unsigned int oldval = reg->cell[cell]->value;
+          if (cells & 1)
+            values |= g->cell[r_cell[cell]];     // values of all cells in 'cells' of subset
+          cells >>= 1;
+        }
+
+        if (NB_BITS (values) < NB_BITS (bits))
+          return (-1);            // Invalid grid
+        else if (NB_BITS (values) == NB_BITS (bits))
+        {
+          // cells of region other than those of 'cells' do not contain values of 'values'
+          unsigned int skimLevel = 0;
+          unsigned int othercells = ~bits;
 
-            reg->cell[cell]->value &= ~values;  // remove values of all cells in 'othercells' of region
-            if (oldval != reg->cell[cell]->value)
+          for (unsigned int cell = 0; cell < GRID_SIZE; cell++)
+          {
+            if (othercells & 1)
             {
-              skimLevel = NB_BITS[bits];
-              if (grid_cell_changed (reg->grid, reg->cell[cell]))
-              {
-                int nbCells = GRID_SIZE * GRID_SIZE - grid_countEmptyCells (reg->grid);
+              unsigned int oldval = g->cell[r_cell[cell]];
 
-                sprintf (stats->theSolution[nbCells - 1], "%2i. %s=%c", nbCells, reg->cell[cell]->name,
-                         VALUE (reg->cell[cell]->value));
+              g->cell[r_cell[cell]] &= ~values;  // remove values of all cells in 'othercells' of region
+              if (oldval != g->cell[r_cell[cell]])
+              {
+                skimLevel = NB_BITS (bits);
+                if (grid_cell_changed (g, r_cell[cell], oldval, stats))
+                  grid_step_record (g, r_cell[cell], 0, stats);
+                if (g->cell[r_cell[cell]] == 0)
+                  return (-1);    // Invalid grid
               }
-              if (reg->cell[cell]->value == 0)
-                return (-1);    // Invalid grid
             }
+            othercells >>= 1;
           }
-          othercells >>= 1;
-        }
-        if (skimLevel)
-        {
-          if (sudokuOnMessageHandlers)
+          if (skimLevel)
           {
-            unsigned int d = 0;
-            char noprint = 0;
+            if (stats->ctx->sudokuOnMessageHandlers)
+            {
+              unsigned int d = 0;
+              char noprint = 0;
 
-            if (NB_BITS[bits] == 1)
-              for (unsigned int cells = bits; cells; cells >>= 1, d++)
-                if (cells & 1 && reg->cell[d]->given)
-                  noprint = 1;
+              if (NB_BITS (bits) == 1)
+                for (unsigned int cells = bits; cells; cells >>= 1, d++)
+                  if (cells & 1 && stats->given[r_cell[d]])
+                    noprint = 1;
 
-            char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
+              char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-            // Display:
-            char names[GRID_SIZE * 3 + 2] = " ";
+              // Display:
+              char names[GRID_SIZE * 3 + 2] = " ";
 
-            d = 0;
-            for (unsigned int cells = bits; cells; cells >>= 1, d++)
-              if (cells & 1)
-              {
-                strcat (names, reg->cell[d]->name);
-                strcat (names, " ");
-              }
+              d = 0;
+              for (unsigned int cells = bits; cells; cells >>= 1, d++)
+                if (cells & 1)
+                {
+                  strcat (names, CELL_NAME[r_cell[d]]);
+                  strcat (names, " ");
+                }
 
-            if (NB_BITS[bits] > 1)
-            {
-              MESSAGE_APPEND (rule, _("%s: each one of the %i cells [%s] can only accept one of the %i values (%s).\n\
--> %s: each one of the %i values (%s) can only lie in one of the %i cells [%s].\n"), reg->name, NB_BITS[values], names, NB_BITS[values], VALUES (values), reg->name, NB_BITS[values], VALUES (values), NB_BITS[values], names);
+              if (NB_BITS (bits) > 1)
+              {
+                MESSAGE_APPEND (rule, _("%s: each one of the %i cells [%s] can only accept one of the %i values (%s).\n\
+-> %s: each one of the %i values (%s) can only lie in one of the %i cells [%s].\n"), REGION_NAME[ir], NB_BITS (values), names, NB_BITS (values), VALUES (stats->ctx, values), REGION_NAME[ir], NB_BITS (values), VALUES (stats->ctx, values), NB_BITS (values), names);
 
-              sudoku_on_message (reg->grid->id, get_message_args (rule, 1));
-            }
-            else if (!noprint)
-            {
-              MESSAGE_APPEND (rule, _("%s: the cell [%s] can only accept the value (%s).\n\
--> %s: the value (%s) can only lie in the cell [%s].\n"), reg->name, names, VALUES (values), reg->name, VALUES (values), names);
+                sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 1));
+              }
+              else if (!noprint)
+              {
+                MESSAGE_APPEND (rule, _("%s: the cell [%s] can only accept the value (%s).\n\
+-> %s: the value (%s) can only lie in the cell [%s].\n"), REGION_NAME[ir], names, VALUES (stats->ctx, values), REGION_NAME[ir], VALUES (stats->ctx, values), names);
 
-              sudoku_on_message (reg->grid->id, get_message_args (rule, 3));
+                sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 3));
+              }
             }
-          }
 
-          stats->nbRules++;
-          stats->rC[skimLevel - 1]++;
-          if (skimLevel > 1)
-            return (skimLevel);
-          else
-            stop = skimLevel;
-        }                       // if (skimLevel)
-      }                         // if (NB_BITS[values] == NB_BITS[bits])
-
-      ////////////////////////////////////////////
-      // value exclusion rule
-      ////////////////////////////////////////////
-
-      cells = 0;
-      for (unsigned int cell = GRID_SIZE; cell > 0; cell--)
-      {
-        cells <<= 1;
-        if (bits & reg->cell[cell - 1]->value)  // cell of region contains at least one value in 'bits'
-          cells |= 1;
+            stats->nbRules++;
+            stats->rC[skimLevel - 1]++;
+            if (skimLevel > 1)
+              return (skimLevel);
+            else
+              stop = skimLevel;
+          }                       // if (skimLevel)
+        }                         // if (NB_BITS (values) == NB_BITS (bits))
       }
 
-      if (NB_BITS[bits] > NB_BITS[cells])
-        return (-1);            // Invalid grid
-      else if (NB_BITS[bits] == NB_BITS[cells])
+      if (bits == s2.subset)
       {
-        // values other than those of 'bits' are not contained in cells of cells
-        unsigned int tmp = cells;
-        unsigned int skimLevel = 0;
-        unsigned int othervalues = ~bits;
+        subsets_next (&s2);
 
-        for (unsigned int cell = 0; cell < GRID_SIZE; cell++)
+        ////////////////////////////////////////////
+        // value exclusion rule
+        ////////////////////////////////////////////
+
+        cells = 0;
+        for (unsigned int cell = GRID_SIZE; cell > 0; cell--)
         {
-          if (cells & 1)
-          {
-            unsigned int oldval = reg->cell[cell]->value;
+          cells <<= 1;
+          if (bits & g->cell[r_cell[cell - 1]])  // cell of region contains at least one value in 'bits'
+            cells |= 1;
+        }
+
+        if (NB_BITS (bits) > NB_BITS (cells))
+          return (-1);            // Invalid grid
+        else if (NB_BITS (bits) == NB_BITS (cells))
+        {
+          // values other than those of 'bits' are not contained in cells of cells
+          unsigned int tmp = cells;
+          unsigned int skimLevel = 0;
+          unsigned int othervalues = ~bits;
 
-            reg->cell[cell]->value &= ~othervalues;     // remove other values of all cells in 'cells' of region
-            if (oldval != reg->cell[cell]->value)
+          for (unsigned int cell = 0; cell < GRID_SIZE; cell++)
+          {
+            if (cells & 1)
             {
-              skimLevel = NB_BITS[bits];
-              if (grid_cell_changed (reg->grid, reg->cell[cell]))
-              {
-                int nbCells = GRID_SIZE * GRID_SIZE - grid_countEmptyCells (reg->grid);
+              unsigned int oldval = g->cell[r_cell[cell]];
 
-                sprintf (stats->theSolution[nbCells - 1], "%2i. %s=%c", nbCells, reg->cell[cell]->name,
-                         VALUE (reg->cell[cell]->value));
+              g->cell[r_cell[cell]] &= ~othervalues;     // remove other values of all cells in 'cells' of region
+              if (oldval != g->cell[r_cell[cell]])
+              {
+                skimLevel = NB_BITS (bits);
+                if (grid_cell_changed (g, r_cell[cell], oldval, stats))
+                  grid_step_record (g, r_cell[cell], 0, stats);
+                if (g->cell[r_cell[cell]] == 0)
+                  return (-1);    // Invalid grid
               }
-              if (reg->cell[cell]->value == 0)
-                return (-1);    // Invalid grid
             }
+            cells >>= 1;
           }
-          cells >>= 1;
-        }
-        if (skimLevel)
-        {
-          if (sudokuOnMessageHandlers)
+          if (skimLevel)
           {
-            unsigned int d = 0;
-            char noprint = 0;
+            if (stats->ctx->sudokuOnMessageHandlers)
+            {
+              unsigned int d = 0;
+              char noprint = 0;
 
-            if (NB_BITS[bits] == 1)
-              for (unsigned int cells = tmp; cells; cells >>= 1, d++)
-                if (cells & 1 && reg->cell[d]->given)
-                  noprint = 1;
+              if (NB_BITS (bits) == 1)
+                for (unsigned int cells = tmp; cells; cells >>= 1, d++)
+                  if (cells & 1 && stats->given[r_cell[d]])
+                    noprint = 1;
 
-            char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
+              char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-            // Display:
-            char names[GRID_SIZE * 3 + 2] = " ";
+              // Display:
+              char names[GRID_SIZE * 3 + 2] = " ";
 
-            d = 0;
-            for (unsigned int cells = tmp; cells; cells >>= 1, d++)
-              if (cells & 1)
-              {
-                strcat (names, reg->cell[d]->name);
-                strcat (names, " ");
-              }
+              d = 0;
+              for (unsigned int cells = tmp; cells; cells >>= 1, d++)
+                if (cells & 1)
+                {
+                  strcat (names, CELL_NAME[r_cell[d]]);
+                  strcat (names, " ");
+                }
 
-            if (NB_BITS[bits] > 1)
-            {
-              MESSAGE_APPEND (rule, _("%s: each one of the %i values (%s) can only lie in one of the %i cells [%s].\n\
--> %s: each one of the %i cells [%s] can only accept one of the %i values (%s).\n"), reg->name, NB_BITS[bits], VALUES (bits), NB_BITS[bits], names, reg->name, NB_BITS[bits], names, NB_BITS[bits], VALUES (bits));
+              if (NB_BITS (bits) > 1)
+              {
+                MESSAGE_APPEND (rule, _("%s: each one of the %i values (%s) can only lie in one of the %i cells [%s].\n\
+-> %s: each one of the %i cells [%s] can only accept one of the %i values (%s).\n"), REGION_NAME[ir], NB_BITS (bits), VALUES (stats->ctx, bits), NB_BITS (bits), names, REGION_NAME[ir], NB_BITS (bits), names, NB_BITS (bits), VALUES (stats->ctx, bits));
 
-              sudoku_on_message (reg->grid->id, get_message_args (rule, 1));
-            }
-            else if (!noprint)
-            {
-              MESSAGE_APPEND (rule, _("%s: the value (%s) can only lie in the cell [%s].\n\
--> %s: the cell [%s] can only accept the value (%s).\n"), reg->name, VALUES (bits), names, reg->name, names, VALUES (bits));
+                sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 1));
+              }
+              else if (!noprint)
+              {
+                MESSAGE_APPEND (rule, _("%s: the value (%s) can only lie in the cell [%s].\n\
+-> %s: the cell [%s] can only accept the value (%s).\n"), REGION_NAME[ir], VALUES (stats->ctx, bits), names, REGION_NAME[ir], names, VALUES (stats->ctx, bits));
 
-              sudoku_on_message (reg->grid->id, get_message_args (rule, 2));
+                sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 2));
+              }
             }
-          }
 
-          stats->nbRules++;
-          stats->rV[skimLevel - 1]++;
-          if (skimLevel > 1)
-            return (skimLevel);
-          else
-            stop = skimLevel;
-        }                       // if (skimLevel)
-      }                         // if (NB_BITS[bits] == NB_BITS[cells])
-    }                           // for (unsigned int index=SUBSET_INDEX[depth-1] ; index<SUBSET_INDEX[depth] ; index++)
-  }                             // for (unsigned int depth = 1 ; depth<=9 && !stop ; depth++)
+            stats->nbRules++;
+            stats->rV[skimLevel - 1]++;
+            if (skimLevel > 1)
+              return (skimLevel);
+            else
+              stop = skimLevel;
+          }                       // if (skimLevel)
+        }                         // if (NB_BITS (bits) == NB_BITS (cells))
+      }
+    }                           // while (s1.subset != SUBSET_END || s2.subset != SUBSET_END)
+  }                             // for (unsigned int depth = 1 ; depth<=maxDepth && !stop ; depth++)
 
   return stop;
 }
 
-/// Counts empty cells.
-/// @param[in] g grid
-/// @return Number of empty cells
-static int
-grid_countEmptyCells (grid * g)
-{
-  int ret = GRID_SIZE * GRID_SIZE;
-
-  for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
-    if (NB_BITS[g->cell[i / GRID_SIZE][i % GRID_SIZE].value] == 1)
-      ret--;
-
-  return (ret);
-}
-
-/// Constructs event arguments for handler.
+/// Constructs a view of a grid for handlers.
 /// @param[in] g grid
-/// @returns event argument.
-static sudoku_grid_event_args
-get_event_args (grid * g)
+/// @returns view of the grid, valid as long as the grid is.
+static sudoku_grid_view
+grid_view (const grid * g)
 {
-  sudoku_grid_event_args sudokuOnEventArgs;
-
-  for (int r = 0; r < GRID_SIZE; r++)
-    for (int c = 0; c < GRID_SIZE; c++)
-      for (int v = 0; v < GRID_SIZE; v++)
-        if (g->cell[r][c].value & (1 << v))
-          sudokuOnEventArgs.grid[r][c][v] = v + 1;
-        else
-          sudokuOnEventArgs.grid[r][c][v] = 0;
+  sudoku_grid_view view = { g->cell, 0, g->nbFilled };
 
-  sudokuOnEventArgs.nbCells = GRID_SIZE * GRID_SIZE - grid_countEmptyCells (g);
-
-  return (sudokuOnEventArgs);
+  return (view);
 }
 
-/// Initialize a grid.
-/// @param[in] g Grid
+/// Initialize the topology of grids (cells of regions and intersections) and the names of cells.
 static void
-grid_init (grid * g)
+grid_topology_init (void)
 {
+  for (int r = 0; r < GRID_SIZE; r++)   // 9 rows
+    for (int c = 0; c < GRID_SIZE; c++) // 9 colmuns
+    {
+      CELL_NAME[r * GRID_SIZE + c][0] = ROW_NAME[r];
+      CELL_NAME[r * GRID_SIZE + c][1] = COLUMN_NAME[c];
+      CELL_NAME[r * GRID_SIZE + c][2] = 0;
+    }
+
   for (int r = 0; r < GRID_SIZE * 3; r++)       // 27 regions
   {
-    g->region[r].grid = g;
-
     regionType t = r / GRID_SIZE;
 
     switch (t)
     {
       case ROW:
         for (int c = 0; c < GRID_SIZE; c++)     // 9 cells of region
-          g->region[r].cell[c] = &(g->cell[r % GRID_SIZE][c]);
+          REGION_CELL[r][c] = (r % GRID_SIZE) * GRID_SIZE + c;
         break;
       case COLUMN:
         for (int c = 0; c < GRID_SIZE; c++)     // 9 cells of region
-          g->region[r].cell[c] = &(g->cell[c][r % GRID_SIZE]);
+          REGION_CELL[r][c] = c * GRID_SIZE + r % GRID_SIZE;
         break;
       case SQUARE:
         for (int c = 0; c < GRID_SIZE; c++)     // 9 cells of region
-          g->region[r].cell[c] =
-            &(g->cell[c / SQUARE_SIZE + SQUARE_SIZE * ((r % GRID_SIZE) / SQUARE_SIZE)][c % SQUARE_SIZE +
-                                                                                       SQUARE_SIZE * (r %
-                                                                                                      SQUARE_SIZE)]);
+          REGION_CELL[r][c] =
+            (c / SQUARE_SIZE + SQUARE_SIZE * ((r % GRID_SIZE) / SQUARE_SIZE)) * GRID_SIZE + c % SQUARE_SIZE +
+            SQUARE_SIZE * (r % SQUARE_SIZE);
         break;
     }
   }
 
   for (int i = 0; i < GRID_SIZE * SQUARE_SIZE * 2; i++) // 54 intersections
   {
-    g->intersection[i].grid = g;
-
     regionType direction = i / (GRID_SIZE * SQUARE_SIZE);
     int inter = i % (GRID_SIZE * SQUARE_SIZE);
 
@@ -1261,9 +1695,9 @@ grid_init (grid * g)
 
           for (int k = 0; k < SQUARE_SIZE - 1; k++)
           {
-            g->intersection[i].r1_cell[j + SQUARE_SIZE * k] = &(g->cell[r][(c + SQUARE_SIZE * (k + 1)) % GRID_SIZE]);
-            g->intersection[i].r2_cell[j + SQUARE_SIZE * k] =
-              &(g->cell[SQUARE_SIZE * (r / SQUARE_SIZE) + (r + k + 1) % SQUARE_SIZE][c]);
+            INTERSECTION_CELL[i][0][j + SQUARE_SIZE * k] = r * GRID_SIZE + (c + SQUARE_SIZE * (k + 1)) % GRID_SIZE;
+            INTERSECTION_CELL[i][1][j + SQUARE_SIZE * k] =
+              (SQUARE_SIZE * (r / SQUARE_SIZE) + (r + k + 1) % SQUARE_SIZE) * GRID_SIZE + c;
           }
         }
         break;
@@ -1275,9 +1709,9 @@ grid_init (grid * g)
 
           for (int k = 0; k < SQUARE_SIZE - 1; k++)
           {
-            g->intersection[i].r1_cell[j + SQUARE_SIZE * k] = &(g->cell[(r + SQUARE_SIZE * (k + 1)) % GRID_SIZE][c]);
-            g->intersection[i].r2_cell[j + SQUARE_SIZE * k] =
-              &(g->cell[r][SQUARE_SIZE * (c / SQUARE_SIZE) + (c + k + 1) % SQUARE_SIZE]);
+            INTERSECTION_CELL[i][0][j + SQUARE_SIZE * k] = ((r + SQUARE_SIZE * (k + 1)) % GRID_SIZE) * GRID_SIZE + c;
+            INTERSECTION_CELL[i][1][j + SQUARE_SIZE * k] =
+              r * GRID_SIZE + SQUARE_SIZE * (c / SQUARE_SIZE) + (c + k + 1) % SQUARE_SIZE;
           }
         }
         break;
@@ -1286,53 +1720,61 @@ grid_init (grid * g)
         break;
     }
   }
+
+  // Peers of cells
+  for (int cell = 0; cell < GRID_SIZE * GRID_SIZE; cell++)
+  {
+    int n = 0;
+
+    for (int ir = 0; ir < GRID_SIZE * 3; ir++)
+      for (int c = 0; c < GRID_SIZE; c++)
+        if (REGION_CELL[ir][c] == cell)
+          CELL_REGION[cell][n++] = ir;
+
+    n = 0;
+    for (int ir = 0; ir < GRID_SIZE * SQUARE_SIZE * 2; ir++)
+      for (int c = 0; c < (GRID_SIZE - SQUARE_SIZE); c++)
+        if (INTERSECTION_CELL[ir][0][c] == cell || INTERSECTION_CELL[ir][1][c] == cell)
+        {
+          CELL_INTERSECTION[cell][n++] = ir;
+          break;
+        }
+    assert (n == sizeof (CELL_INTERSECTION[cell]) / sizeof (*CELL_INTERSECTION[cell]));
+  }
 }
 
 /// Tag cell as changed.
 /// @param [in] g Grid
-/// @param [in] cell Cell changed
+/// @param [in] cell Index of the cell changed
+/// @param [in] oldval Bit mask of possible values in the cell before the change
+/// @param [in] stats Statistic data
 /// @return 1 if cell has been filled, 0 otherwise
 static int
-grid_cell_changed (grid * g, cell * cell)
+grid_cell_changed (grid * g, int cell, unsigned int oldval, counters * stats)
 {
-  for (int ir = 0; ir < GRID_SIZE * 3; ir++)
-  {
-    if (g->region[ir].changed)
-      continue;
+  g->nbFilled += (NB_BITS (g->cell[cell]) == 1) - (NB_BITS (oldval) == 1);
 
-    for (int c = 0; c < GRID_SIZE; c++)
-      if (g->region[ir].cell[c] == cell)
-      {
-        g->region[ir].changed = 1;
-        break;
-      }
-  }
+  for (int i = 0; i < 3; i++)
+    g->regionDepth[CELL_REGION[cell][i]] = 0;
 
-  for (int ir = 0; ir < GRID_SIZE * SQUARE_SIZE * 2; ir++)
-  {
-    if (g->intersection[ir].changed)
-      continue;
+  // The rules on a value depend on the cells where it is a candidate and on those where it is the only one.
+  for (int v = 0; v < GRID_SIZE; v++)
+    if (oldval & (1U << v))
+      g->valueDepth[v] = 0;
 
-    for (int c = 0; c < (GRID_SIZE - SQUARE_SIZE); c++)
-      if (g->intersection[ir].r1_cell[c] == cell || g->intersection[ir].r2_cell[c] == cell)
-      {
-        g->intersection[ir].changed = 1;
-        break;
-      }
-  }
+  for (int i = 0; i < 4 * (SQUARE_SIZE - 1); i++)
+    g->intersectionChanged[CELL_INTERSECTION[cell][i]] = 1;
 
-  if (NB_BITS[cell->value] == 1)
+  if (NB_BITS (g->cell[cell]) == 1)
   {
-    int nbCells = GRID_SIZE * GRID_SIZE - grid_countEmptyCells (g);
-
-    if (sudokuOnMessageHandlers)
+    if (stats->ctx->sudokuOnMessageHandlers)
     {
       char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-      MESSAGE_APPEND (rule, _("\n  ### Cell %s must contain %c [%2i] ###\n\n"), cell->name, VALUE (cell->value),
-                      nbCells);
+      MESSAGE_APPEND (rule, _("\n  ### Cell %s must contain %c [%2i] ###\n\n"), CELL_NAME[cell],
+                      VALUE (g->cell[cell]), g->nbFilled);
       if (*rule)
-        sudoku_on_message (0, get_message_args (rule, 1));
+        sudoku_on_message (stats->ctx, 0, get_message_args (rule, 1));
     }
     return 1;
   }
@@ -1345,8 +1787,9 @@ grid_cell_changed (grid * g, cell * cell)
 /// @param[in] c Column
 /// @param[in] l Line
 /// @param[in] v Value
+/// @param[out] stats Statistic data, in which the given cells are recorded
 static void
-grid_initCell (grid * g, int l, int c, int v)
+grid_initCell (grid * g, int l, int c, int v, counters * stats)
 {
   if (l < 0 || l >= GRID_SIZE || c < 0 || c >= GRID_SIZE || v < 0 || v > GRID_SIZE)
     return;
@@ -1355,50 +1798,101 @@ grid_initCell (grid * g, int l, int c, int v)
 
   if (v == 0)
   {
-    g->cell[l][c].value = all;
-    g->cell[l][c].given = 0;
+    g->cell[l * GRID_SIZE + c] = all;
+    stats->given[l * GRID_SIZE + c] = 0;
   }
   else
   {
-    g->cell[l][c].value = (1 << (v - 1));
-    g->cell[l][c].given = 1;
+    g->cell[l * GRID_SIZE + c] = (1 << (v - 1));
+    stats->given[l * GRID_SIZE + c] = 1;
   }
 }
 
 /// Initialize a grid from an array.
 /// @param[in] g Grid
 /// @param[in] intg Array
+/// @param[out] stats Statistic data, in which the given cells and the grid identifier are recorded
 static void
-grid_init_from_int9x9 (grid * g, int intg[GRID_SIZE][GRID_SIZE])
+grid_init_from_int9x9 (grid * g, int intg[GRID_SIZE][GRID_SIZE], counters * stats)
 {
-  grid_init (g);
-
+  g->nbFilled = 0;
   for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
-    grid_initCell (g, i / GRID_SIZE, i % GRID_SIZE, intg[i / GRID_SIZE][i % GRID_SIZE]);
-
-  for (int r = 0; r < GRID_SIZE; r++)   // 9 rows
-    for (int c = 0; c < GRID_SIZE; c++) // 9 colmuns
-    {
-      g->cell[r][c].name[0] = ROW_NAME[r];
-      g->cell[r][c].name[1] = COLUMN_NAME[c];
-      g->cell[r][c].name[2] = 0;
-    }
-
-  for (int ir = 0; ir < GRID_SIZE * 3; ir++)
   {
-    g->region[ir].changed = 1;
-    g->region[ir].name = REGION_NAME[ir];
+    grid_initCell (g, i / GRID_SIZE, i % GRID_SIZE, intg[i / GRID_SIZE][i % GRID_SIZE], stats);
+    if (NB_BITS (g->cell[i]) == 1)
+      g->nbFilled++;
   }
 
+  for (int ir = 0; ir < GRID_SIZE * 3; ir++)
+    g->regionDepth[ir] = 0;
+
+  for (int v = 0; v < GRID_SIZE; v++)
+    g->valueDepth[v] = 0;
+
   for (int ir = 0; ir < GRID_SIZE * SQUARE_SIZE * 2; ir++)
-  {
-    g->intersection[ir].changed = 1;
-    g->intersection[ir].name = INTERSECTION_NAME[ir];
-  }
+    g->intersectionChanged[ir] = 1;
+
+  stats->gridId = (uintptr_t) g;
+}
+
+#ifdef SUDOKU_PROFILE
+/// Measure of a call to a probed function.
+typedef struct
+{
+  struct timespec start;        ///< Time of the call
+  int nbCandidates;             ///< Number of candidates of the grid at the time of the call
+} probe;
 
-  g->id = (uintptr_t) g;
+/// Counts the candidates of a grid.
+/// @param[in] g Grid
+/// @return Number of candidates
+static int
+grid_nb_candidates (const grid * g)
+{
+  int n = 0;
+
+  for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+    n += NB_BITS (g->cell[i]);
+  return n;
+}
+
+/// Starts the measure of a call to a probed function.
+/// @param[in] g Grid processed by the function, or null
+/// @return Measure
+static probe
+probe_start (const grid * g)
+{
+  probe p = {.nbCandidates = g ? grid_nb_candidates (g) : 0 };
+
+  clock_gettime (CLOCK_MONOTONIC, &p.start);
+  return p;
+}
+
+/// Ends the measure of a call to a probed function.
+/// @param[in] p Measure
+/// @param[in,out] profile Costs of the function, to which the measure is added
+/// @param[in] g Grid processed by the function, or null if the eliminated candidates are not to be counted
+static void
+probe_stop (const probe * p, sudoku_profile * profile, const grid * g)
+{
+  struct timespec stop;
+
+  clock_gettime (CLOCK_MONOTONIC, &stop);
+  profile->calls++;
+  profile->nanoseconds += (stop.tv_sec - p->start.tv_sec) * 1000000000LL + stop.tv_nsec - p->start.tv_nsec;
+  if (g)
+    profile->eliminated += p->nbCandidates - grid_nb_candidates (g);
 }
 
+/// Starts the measure of a call to a probed function, processing the grid g.
+#  define PROBE_START(name, g) probe name = probe_start (g)
+/// Ends the measure of a call to the probed function id, processing the grid g.
+#  define PROBE_STOP(name, stats, id, g) probe_stop (&name, &(stats)->profile[id], g)
+#else
+#  define PROBE_START(name, g)
+#  define PROBE_STOP(name, stats, id, g)
+#endif
+
 /// Copy a grid.
 /// @param[in] dest Destination grid
 /// @param[in] src Source grid
@@ -1412,38 +1906,47 @@ grid_copy (grid * dest, grid * src)
   }
 
   *dest = *src;
-  grid_init (dest);
 }
 
 /// Eliminates regions.
 /// @param [in] g Grid
+/// @param [in] depth Size of the largest subsets of rows or columns searched
 /// @param [out] stats Statistic data
 /// @return 1 if some candidates have been excluded, 0 otherwise, -1 if g is invalide
 static int
-grid_skimValues (grid * g, counters * stats)
+grid_skimValues (grid * g, unsigned int depth, counters * stats)
 {
   int gridSkimmed = 0;
 
   for (unsigned int value = 1; value <= GRID_SIZE; value++)
   {
-    int ret = value_skim (g, value, stats);
+    unsigned int from = g->valueDepth[value - 1] + 1;
+
+    if (from > depth)
+      continue;
+
+    g->valueDepth[value - 1] = depth;   // reset if the rules modify the candidates of the value
+    PROBE_START (p, g);
+    int ret = value_skim (g, value, from, depth, stats);
+
+    PROBE_STOP (p, stats, SUDOKU_PROBE_VALUE_SKIM, g);
 
     if (ret > 0)
     {
       if (ret > gridSkimmed)
         gridSkimmed = ret;
 
-      if ( /*ret > 1 && */ sudokuOnChangeEventHandlers)
-        sudoku_on_change (g->id, get_event_args (g));
+      if ( /*ret > 1 && */ stats->ctx->sudokuOnChangeEventHandlers)
+        sudoku_on_change (stats->ctx, stats->gridId, grid_view (g));
     }                           // if (ret>0)
     else if (ret < 0)
     {
-      if (sudokuOnMessageHandlers)
+      if (stats->ctx->sudokuOnMessageHandlers)
       {
         char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
         MESSAGE_APPEND (rule, _("  => Invalid grid.\n"));
-        sudoku_on_message (g->id, get_message_args (rule, 1));
+        sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 1));
       }
       return (ret);             // Invalid grid
     }                           // if (ret<0)
@@ -1454,37 +1957,43 @@ grid_skimValues (grid * g, counters * stats)
 
 /// Eliminates candidates in regions.
 /// @param [in] g Grid
+/// @param [in] depth Size of the largest subsets of cells or values searched
 /// @param [out] stats Statistic data
 /// @return 1 if some candidates have been excluded, 0 otherwise, -1 if g is invalide
 static int
-grid_skimRegions (grid * g, counters * stats)
+grid_skimRegions (grid * g, unsigned int depth, counters * stats)
 {
   int gridSkimmed = 0;
 
   for (int ir = 0; ir < GRID_SIZE * 3; ir++)
   {
-    if (g->region[ir].changed == 0)
+    unsigned int from = g->regionDepth[ir] + 1;
+
+    if (from > depth)
       continue;
 
-    g->region[ir].changed = 0;
-    int ret = region_skim (&(g->region[ir]), stats);
+    g->regionDepth[ir] = depth; // reset if the rules modify the region
+    PROBE_START (p, g);
+    int ret = region_skim (g, ir, from, depth, stats);
+
+    PROBE_STOP (p, stats, SUDOKU_PROBE_REGION_SKIM, g);
 
     if (ret > 0)
     {
       if (ret > gridSkimmed)
         gridSkimmed = ret;
 
-      if ( /*ret > 1 && */ sudokuOnChangeEventHandlers)
-        sudoku_on_change (g->id, get_event_args (g));
+      if ( /*ret > 1 && */ stats->ctx->sudokuOnChangeEventHandlers)
+        sudoku_on_change (stats->ctx, stats->gridId, grid_view (g));
     }                           // if (ret>0)
     else if (ret < 0)
     {
-      if (sudokuOnMessageHandlers)
+      if (stats->ctx->sudokuOnMessageHandlers)
       {
         char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
         MESSAGE_APPEND (rule, _("  => Invalid grid.\n"));
-        sudoku_on_message (g->id, get_message_args (rule, 1));
+        sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 1));
       }
       return (ret);             // Invalid grid
     }                           // if (ret<0)
@@ -1503,36 +2012,299 @@ grid_skimIntersections (grid * g, counters * stats)
 
   for (int ir = 0; ir < GRID_SIZE * SQUARE_SIZE * 2; ir++)
   {
-    if (g->intersection[ir].changed == 0)
+    if (g->intersectionChanged[ir] == 0)
       continue;
 
-    g->intersection[ir].changed = 0;
-    int ret = intersection_skim (&(g->intersection[ir]), stats);
+    g->intersectionChanged[ir] = 0;
+    PROBE_START (p, g);
+    int ret = intersection_skim (g, ir, stats);
+
+    PROBE_STOP (p, stats, SUDOKU_PROBE_INTERSECTION_SKIM, g);
 
     if (ret > 0)
     {
       gridSkimmed += ret;
-      if (sudokuOnChangeEventHandlers)
-        sudoku_on_change (g->id, get_event_args (g));
+      if (stats->ctx->sudokuOnChangeEventHandlers)
+        sudoku_on_change (stats->ctx, stats->gridId, grid_view (g));
     }
   }
   return gridSkimmed;
 }
 
-/// Solves a grid.
+/// Eliminates candidates by applying the rules by increasing cost.
 /// @param [in] g Grid
-/// @param [in] find \c FIRST to find the first solution or \c ALL to find all solutions
 /// @param [out] stats Statistic data
-/// @return 1 if some candidates have been excluded, 0 otherwise, -1 if g is invalide
+/// @return 0 once no rule applies or a hypothesis is preferred, -1 if g is invalide
+///
+/// Singles (subsets of size 1) and intersections are applied to the whole grid first. The size of the subsets
+/// searched then grows by one as long as no rule applies, and falls back to 1 as soon as one does.
+static int
+grid_skimByCost (grid * g, counters * stats)
+{
+  const unsigned int regionDepth = stats->schedule.regionDepth;
+  const unsigned int valueDepth = stats->schedule.valueDepth;
+  const unsigned int maxDepth = regionDepth > valueDepth ? regionDepth : valueDepth;
+
+  for (unsigned int depth = 1; depth <= maxDepth;)
+  {
+    int r = grid_skimRegions (g, depth < regionDepth ? depth : regionDepth, stats);
+
+    if (r == 0)
+      r = grid_skimValues (g, depth < valueDepth ? depth : valueDepth, stats);
+    if (r == 0 && depth == 1)
+      r = grid_skimIntersections (g, stats);
+
+    if (r < 0)
+      return (-1);
+    else if (r)
+      depth = 1;
+    else if (stats->schedule.hypothesisDepth > 0 && depth >= (unsigned int) stats->schedule.hypothesisDepth
+             && depth < maxDepth)
+    {
+      // A hypothesis on a cell with two candidates is cheaper than the search of larger subsets.
+      for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+        if (NB_BITS (g->cell[i]) == 2)
+          return 0;
+      depth++;
+    }
+    else
+      depth++;
+  }
+
+  return 0;
+}
+
+/// Level of the explicit stack of the search of the elimination method, each one holding the grid on which
+/// hypotheses are made, the next one the grid of the current hypothesis.
+struct search_level
+{
+  grid g;                       ///< Grid of the level, on which the rules are applied
+  int ipivot;                   ///< Index of the cell on which the hypotheses of the level are made
+  unsigned int bits;            ///< Candidates of the pivot not tried yet
+  unsigned int value;           ///< Candidate of the current hypothesis
+  int nbCells;                  ///< Number of filled cells with the current hypothesis
+  int retCode;                  ///< Backtracking level of the solution found from the level, -1 if none
+#ifdef SUDOKU_PROFILE
+  probe p;                      ///< Measure of the current hypothesis
+#endif
+};
+
+/// Hypothesis explored by a thread of its own.
+typedef struct
+{
+  grid clone;                   ///< Grid on which the hypothesis is made
+  counters stats;               ///< Statistic data of the exploration of the hypothesis
+  int ret;                      ///< Value returned by grid_solveByElimination()
+  pthread_t thread;             ///< Thread exploring the hypothesis
+} hypothesis;
+
+static int grid_solveByElimination (grid * g, counters * stats);
+
+/// Returns the current time.
+/// @return Time in nanoseconds, from a monotonic clock
+static long long
+clock_now (void)
+{
+  struct timespec t;
+
+  clock_gettime (CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+/// Tells whether a limit of the resolution (cancellation, number of hypotheses, deadline) has been reached.
+/// @param [in,out] stats Statistic data, the status of which records the first limit reached
+/// @return 1 if the search is to stop, 0 otherwise
+static int
+search_interrupted (counters * stats)
+{
+  if (stats->status != SEARCH_COMPLETE)
+    return 1;
+  if (stats->cancelled && atomic_load_explicit (stats->cancelled, memory_order_relaxed))
+    stats->status = SEARCH_CANCELLED;
+  else if (stats->maxTries > 0 && stats->backtrackingTries >= stats->maxTries)
+    stats->status = SEARCH_BUDGET;
+  else if (stats->deadline > 0 && !(stats->nbChecks++ & stats->clockPeriod) && clock_now () >= stats->deadline)
+    stats->status = SEARCH_DEADLINE;
+  return stats->status != SEARCH_COMPLETE;
+}
+
+/// Tells whether the search has found as many solutions as requested, or has been cancelled or interrupted.
+/// @param [in,out] stats Statistic data
+/// @return 1 if the search can stop, 0 otherwise
+static int
+search_completed (counters * stats)
+{
+  return (stats->limit > 0 && (stats->nbSolutions >= stats->limit
+                               || (stats->found && atomic_load (stats->found) >= stats->limit)))
+    || (stats->cancel && atomic_load_explicit (stats->cancel, memory_order_relaxed)) || search_interrupted (stats);
+}
+
+/// Gets the message telling why a search stopped.
+/// @param [in] status Outcome of the search
+/// @return Message, empty if the search was complete
+static const char *
+search_status_message (searchStatus status)
+{
+  return status == SEARCH_DEADLINE ? _("Search stopped: timeout expired.\n") :
+    status == SEARCH_BUDGET ? _("Search stopped: maximum number of hypotheses reached.\n") :
+    status == SEARCH_CANCELLED ? _("Search stopped: cancelled.\n") : "";
+}
+
+static void *
+hypothesis_explore (void *arg)
+{
+  hypothesis *const h = arg;
+
+  PROBE_START (p, 0);
+  h->ret = grid_solveByElimination (&h->clone, &h->stats);
+  PROBE_STOP (p, &h->stats, SUDOKU_PROBE_HYPOTHESIS, 0);
+  return 0;
+}
+
+/// Explores the hypotheses on a cell in parallel, one thread per candidate value.
+/// @param [in] g Grid
+/// @param [in] ipivot Index of the cell on which hypotheses are made
+/// @param [in,out] stats Statistic data, to which the statistics of the hypotheses are added
+/// @return The backtracking level of the solution found, -1 if no hypothesis leads to a solution
+static int
+grid_exploreHypotheses (grid * g, int ipivot, counters * stats)
+{
+  unsigned int candidates = g->cell[ipivot];
+  int nbHypotheses = NB_BITS (candidates);
+  hypothesis *const h = malloc (nbHypotheses * sizeof (*h));
+
+  if (h == 0)
+  {
+    fprintf (stderr, _("Memory allocation error (%s, %s, %i)\n"), __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+
+  atomic_int found = 0;         // shared by all the threads below the first parallel level
+  int nb = 0;
+  unsigned int value = 1;
+
+  for (unsigned int bits = candidates; bits != 0; bits >>= 1, value <<= 1)
+  {
+    if (!(bits & 1))
+      continue;
+
+    PROBE_START (p, 0);
+    grid_copy (&h[nb].clone, g);
+    PROBE_STOP (p, stats, SUDOKU_PROBE_GRID_COPY, 0);
+    h[nb].clone.cell[ipivot] = value;   // cell modified here, not yet counted as filled
+    h[nb].stats = *stats;
+    counters *const s = &h[nb].stats;
+
+    grid_cell_changed (&h[nb].clone, ipivot, candidates, s);
+    grid_step_record (&h[nb].clone, ipivot, 1, s);
+
+    // Each thread searches on a stack of its own.
+    if (!(s->stack = malloc ((GRID_SIZE * GRID_SIZE - h[nb].clone.nbFilled + 1) * sizeof (*s->stack))))
+    {
+      fprintf (stderr, _("Memory allocation error (%s, %s, %i)\n"), __func__, __FILE__, __LINE__);
+      exit (-1);
+    }
+
+    // Counters are collected per thread and summed up afterwards.
+    s->nbSolutions = s->nbRules = s->backtrackingSteps = s->backtrackingTries = s->rI = 0;
+    for (int i = 0; i < GRID_SIZE; i++)
+      s->rC[i] = s->rV[i] = s->rR[i] = 0;
+#ifdef SUDOKU_PROFILE
+    memset (s->profile, 0, sizeof (s->profile));
+#endif
+    if (s->maxTries > 0)        // what is left of the budget is shared between the threads
+      s->maxTries = stats->maxTries > stats->backtrackingTries + nbHypotheses ?
+        (stats->maxTries - stats->backtrackingTries) / nbHypotheses : 1;
+    s->backtrackingLevel++;
+    s->parallelDepth--;
+    if (s->found == 0)
+      s->found = &found;
+    nb++;
+  }
+
+  // The calling thread explores the first hypothesis itself.
+  for (int i = 1; i < nb; i++)
+    if (pthread_create (&h[i].thread, 0, hypothesis_explore, &h[i]))
+    {
+      fprintf (stderr, _("Unexpected error (%s, %s, %i).\n"), __func__, __FILE__, __LINE__);
+      exit (-1);
+    }
+  hypothesis_explore (&h[0]);
+  for (int i = 1; i < nb; i++)
+    pthread_join (h[i].thread, 0);
+
+  // Hypotheses are merged in the order of the sequential search.
+  int retCode = -1;
+
+  for (int i = 0; i < nb; i++)
+  {
+    counters *const s = &h[i].stats;
+    int nbSteps = h[i].clone.nbFilled - g->nbFilled;
+
+    free (s->stack);
+
+    if (stats->status == SEARCH_COMPLETE)
+      stats->status = s->status;
+    if (nbSteps > stats->backtrackingSteps)
+      stats->backtrackingSteps = nbSteps;
+    if (s->backtrackingSteps > stats->backtrackingSteps)
+      stats->backtrackingSteps = s->backtrackingSteps;
+    stats->backtrackingTries += 1 + s->backtrackingTries;
+    stats->nbRules += s->nbRules;
+    stats->rI += s->rI;
+    for (int j = 0; j < GRID_SIZE; j++)
+    {
+      stats->rC[j] += s->rC[j];
+      stats->rV[j] += s->rV[j];
+      stats->rR[j] += s->rR[j];
+    }
+#ifdef SUDOKU_PROFILE
+    for (int j = 0; j < SUDOKU_NB_PROBES; j++)
+    {
+      stats->profile[j].calls += s->profile[j].calls;
+      stats->profile[j].nanoseconds += s->profile[j].nanoseconds;
+      stats->profile[j].eliminated += s->profile[j].eliminated;
+    }
+    stats->profile[SUDOKU_PROBE_HYPOTHESIS].eliminated += NB_BITS (candidates) - 1;
+#endif
+
+    if (h[i].ret == 0)
+    {
+      fprintf (stderr, _("Unexpected error (%s, %s, %i).\n"), __func__, __FILE__, __LINE__);
+      exit (-1);
+    }
+    else if (h[i].ret < 0)
+      continue;                 // invalid guess, or search stopped
+
+    if (stats->nbSolutions == 0)
+      memcpy (stats->solution, s->solution, sizeof (stats->solution));
+    stats->nbSolutions += s->nbSolutions;
+    if (retCode < 0)
+      stats->backtrackingLevel = retCode = h[i].ret;
+  }
+  if (stats->limit > 0 && stats->nbSolutions > stats->limit)
+    stats->nbSolutions = stats->limit;  // concurrent threads may have found more solutions before stopping
+
+  free (h);
+  return retCode;
+}
+
+/// Applies the rules to a grid until none applies any longer.
+/// @param [in] g Grid
+/// @param [out] stats Statistic data
+/// @return 0 once no rule applies, -1 if g is invalide
 static int
-grid_solveByElimination (grid * g, findSolutions find, counters * stats)
+grid_skim (grid * g, counters * stats)
 {
-  int skim = 1;
+  int skim = stats->tiered ? grid_skimByCost (g, stats) : 1;
+
+  if (skim < 0)
+    return (-1);
 
   while (skim > 0)
   {
     // skim regions
-    int r = grid_skimRegions (g, stats);
+    int r = grid_skimRegions (g, stats->subsetDepth, stats);
 
     skim = r;
     if (r < 0)
@@ -1541,7 +2313,7 @@ grid_solveByElimination (grid * g, findSolutions find, counters * stats)
       continue;
 
     // skim values
-    r = grid_skimValues (g, stats);
+    r = grid_skimValues (g, stats->subsetDepth, stats);
     skim = r;
     if (r < 0)
       return (-1);
@@ -1557,15 +2329,21 @@ grid_solveByElimination (grid * g, findSolutions find, counters * stats)
     skim += i;
   }                             // while ( skim > 0 )
 
-  // MAKE HYPOTHESIS :
-  // the grid is valid but :
-  // no skim done -> needs hypothesis (backtracking, recursive call to grid_solveByElimination)
+  return 0;
+}
+
+/// Chooses the cell on which hypotheses are made.
+/// @param [in] g Grid
+/// @return Index of the cell with the fewest candidates, -1 if the grid is complete
+static int
+grid_pivot (const grid * g)
+{
   int ipivot = -1;
-  unsigned int min = 10;
+  unsigned int min = GRID_SIZE + 1;
 
   for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
   {
-    unsigned int j = NB_BITS[g->cell[i / GRID_SIZE][i % GRID_SIZE].value];
+    unsigned int j = NB_BITS (g->cell[i]);
 
     if (j >= 2 && j < min)
     {
@@ -1576,107 +2354,203 @@ grid_solveByElimination (grid * g, findSolutions find, counters * stats)
     }
   }
 
-  if (ipivot >= 0)
+  return ipivot;
+}
+
+/// Records a solution.
+/// @param [in] g Grid, complete and valid
+/// @param [in,out] stats Statistic data
+/// @return The backtracking level of the solution
+static int
+grid_solved (const grid * g, counters * stats)
+{
+  if (stats->found)
+    atomic_fetch_add (stats->found, 1);
+  if (++stats->nbSolutions == 1)
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+    {
+      int v = 0;
+
+      for (unsigned int bits = g->cell[i]; bits; bits >>= 1)
+        v++;
+      stats->solution[i / GRID_SIZE][i % GRID_SIZE] = v;
+    }
+  if (stats->ctx->sudokuOnMessageHandlers)
   {
-    if (sudokuOnChangeEventHandlers)
-      sudoku_on_change (g->id, get_event_args (g));
+    char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-    int retCode = -1;
-    unsigned int value = 1;
+    MESSAGE_APPEND (rule, _("Solved using elimination method (solution #%i).\n"), stats->nbSolutions);
 
-    for (unsigned int bits = g->cell[ipivot / GRID_SIZE][ipivot % GRID_SIZE].value; bits != 0; bits >>= 1, value <<= 1)
-    {
-      if (!(bits & 1))
-        continue;
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+      if (stats->steps[i].value)
+        MESSAGE_APPEND (rule, "%2i. %s=%c%s%c", i + 1, CELL_NAME[stats->steps[i].cell],
+                        VALUE_NAME[stats->steps[i].value - 1], stats->steps[i].hypothesis ? "?" : "",
+                        ((i + 1) % SQUARE_SIZE ? '\t' : '\n'));
 
-      grid clone;
+    MESSAGE_APPEND (rule, "\n");
+    sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 0));
+  }
+  if (stats->ctx->sudokuOnSolvedEventHandlers)
+    sudoku_on_solved (stats->ctx, stats->gridId, grid_view (g));
 
-      grid_copy (&clone, g);
-      cell *pivot = &(clone.cell[ipivot / GRID_SIZE][ipivot % GRID_SIZE]);
+  return (stats->backtrackingLevel);
+}
 
-      pivot->value = value;     // cell modified here
+/// Makes the next hypothesis of a level of the search.
+/// @param [in,out] l Level
+/// @param [out] next Level above, on the grid of which the hypothesis is made
+/// @param [in,out] stats Statistic data
+/// @return 1 if a hypothesis has been made, 0 if all have been or enough solutions have been found
+static int
+level_hypothesis_push (search_level * l, search_level * next, counters * stats)
+{
+  if (l->bits == 0 || search_completed (stats))
+    return 0;                   // enough solutions may have been found by parallel threads
 
-      //stats->nbSteps++ ;
-      int nbCells = GRID_SIZE * GRID_SIZE - grid_countEmptyCells (&clone);
+  l->value = l->bits & -l->bits;
+  l->bits &= l->bits - 1;
 
-      sprintf (stats->theSolution[nbCells - 1], "%2i. %s=%c?", nbCells, pivot->name, VALUE (pivot->value));
-      if (sudokuOnMessageHandlers)
-      {
-        char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
+#ifdef SUDOKU_PROFILE
+  l->p = probe_start (0);
+#endif
+  PROBE_START (c, 0);
+  grid_copy (&next->g, &l->g);
+  PROBE_STOP (c, stats, SUDOKU_PROBE_GRID_COPY, 0);
+  next->g.cell[l->ipivot] = l->value;   // cell modified here, not yet counted as filled
+  l->nbCells = next->g.nbFilled + 1;
 
-        MESSAGE_APPEND (rule, _("  ??? Hypothesis: cell %s = %c ? (out of %s) [%2i] ???\n"),
-                        pivot->name, VALUE (pivot->value),
-                        VALUES (g->cell[ipivot / GRID_SIZE][ipivot % GRID_SIZE].value), nbCells);
-        //MESSAGE_APPEND (rule, "  [%2i]\n", nbCells);
-        sudoku_on_message (g->id, get_message_args (rule, 1));
-      }
+  if (stats->ctx->sudokuOnMessageHandlers)
+  {
+    char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-      grid_cell_changed (&clone, pivot);
+    MESSAGE_APPEND (rule, _("  ??? Hypothesis: cell %s = %c ? (out of %s) [%2i] ???\n"),
+                    CELL_NAME[l->ipivot], VALUE (l->value), VALUES (stats->ctx, l->g.cell[l->ipivot]), l->nbCells);
+    sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 1));
+  }
 
-      stats->backtrackingTries++;
-      stats->backtrackingLevel++;
-      int k = grid_solveByElimination (&clone, find, stats);
-      int nbSteps = grid_countEmptyCells (g) - grid_countEmptyCells (&clone);
+  grid_cell_changed (&next->g, l->ipivot, l->g.cell[l->ipivot], stats);
+  grid_step_record (&next->g, l->ipivot, 1, stats);
 
-      if (nbSteps > stats->backtrackingSteps)
-        stats->backtrackingSteps = nbSteps;
-      if (k > 0)
-      {
-        stats->backtrackingLevel = retCode = k;
-        if (find == FIRST)
-          return (k);           // don't go further the first solution found
-      }
-      else if (k == 0)
-      {
-        fprintf (stderr, _("Unexpected error (%s, %s, %i).\n"), __func__, __FILE__, __LINE__);
-        exit (-1);
-      }
-      else                      // if (k<0)
-      {                         // Invalid guess
-        stats->backtrackingLevel--;
-        if (sudokuOnMessageHandlers)
-        {
-          char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
+  stats->backtrackingTries++;
+  stats->backtrackingLevel++;
+  return 1;
+}
 
-          MESSAGE_APPEND (rule,
-                          _("  %%%%%% Incorrect guess: cell %s = %c [%2i] (after %i steps). %%%%%%\n"), pivot->name,
-                          VALUE (pivot->value), nbCells, nbSteps);
-          sudoku_on_message (g->id, get_message_args (rule, 1));
-        }
-      }
-    }
-    return (retCode);
+/// Collects the outcome of the current hypothesis of a level of the search.
+/// @param [in,out] l Level
+/// @param [in] next Level above, on which the hypothesis has been explored
+/// @param [in] k The backtracking level of the solution found under the hypothesis, -1 if none
+/// @param [in,out] stats Statistic data
+/// @return 1 if enough solutions have been found, 0 otherwise
+static int
+level_hypothesis_pop (search_level * l, const search_level * next, int k, counters * stats)
+{
+  int nbSteps = next->g.nbFilled - l->g.nbFilled;
+
+#ifdef SUDOKU_PROFILE
+  probe_stop (&l->p, &stats->profile[SUDOKU_PROBE_HYPOTHESIS], 0);
+  stats->profile[SUDOKU_PROBE_HYPOTHESIS].eliminated += NB_BITS (l->g.cell[l->ipivot]) - 1;
+#endif
+
+  if (nbSteps > stats->backtrackingSteps)
+    stats->backtrackingSteps = nbSteps;
+  if (k > 0)
+  {
+    stats->backtrackingLevel = l->retCode = k;
+    return search_completed (stats);    // don't go further the requested number of solutions
   }
-  else                          // the grid is complete and valid
+  else if (k == 0)
   {
-    stats->nbSolutions++;
-    if (sudokuOnMessageHandlers)
+    fprintf (stderr, _("Unexpected error (%s, %s, %i).\n"), __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+  else                          // if (k<0)
+  {                             // Invalid guess
+    stats->backtrackingLevel--;
+    if (stats->ctx->sudokuOnMessageHandlers && stats->status == SEARCH_COMPLETE)   // not a guess if interrupted
     {
       char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-      MESSAGE_APPEND (rule, _("Solved using elimination method (solution #%i).\n"), stats->nbSolutions);
+      MESSAGE_APPEND (rule,
+                      _("  %%%%%% Incorrect guess: cell %s = %c [%2i] (after %i steps). %%%%%%\n"),
+                      CELL_NAME[l->ipivot], VALUE (l->value), l->nbCells, nbSteps);
+      sudoku_on_message (stats->ctx, stats->gridId, get_message_args (rule, 1));
+    }
+  }
+  return 0;
+}
 
-      for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
-        if (stats->theSolution[i][0] != 0)
-          MESSAGE_APPEND (rule, "%s%c", stats->theSolution[i], ((i + 1) % SQUARE_SIZE ? '\t' : '\n'));
+/// Solves a grid.
+/// @param [in,out] g Grid, as left by the search on return
+/// @param [out] stats Statistic data, with the stack of the search
+/// @return The backtracking level of the solution found, -1 if g is invalide
+///
+/// Hypotheses are explored depth first, on the explicit stack of stats rather than by recursion,
+/// which must hold one level more than the number of empty cells of g.
+static int
+grid_solveByElimination (grid * g, counters * stats)
+{
+  search_level *const stack = stats->stack;
+  int top = 0;
+
+  grid_copy (&stack[0].g, g);
+  for (;;)
+  {
+    search_level *const l = &stack[top];
+    int k;
+
+    // Rules are applied until none applies any longer.
+    // MAKE HYPOTHESIS :
+    // the grid is valid but :
+    // no skim done -> needs hypothesis (backtracking, next level of the stack)
+    if (grid_skim (&l->g, stats) < 0)
+      k = -1;
+    else if ((l->ipivot = grid_pivot (&l->g)) < 0)
+      k = grid_solved (&l->g, stats);   // the grid is complete and valid
+    else
+    {
+      if (stats->ctx->sudokuOnChangeEventHandlers)
+        sudoku_on_change (stats->ctx, stats->gridId, grid_view (&l->g));
 
-      MESSAGE_APPEND (rule, "\n");
-      sudoku_on_message (g->id, get_message_args (rule, 0));
+      if (stats->parallelDepth > 0)
+        k = grid_exploreHypotheses (&l->g, l->ipivot, stats);
+      else
+      {
+        l->bits = l->g.cell[l->ipivot];
+        l->retCode = -1;
+        if (level_hypothesis_push (l, l + 1, stats))
+        {
+          top++;
+          continue;
+        }
+        k = l->retCode;
+      }
     }
-    if (sudokuOnSolvedEventHandlers)
-      sudoku_on_solved (g->id, get_event_args (g));
 
-    return (stats->backtrackingLevel);
+    // The outcome of the level is collected by the levels below, down to the one with hypotheses left to explore.
+    for (;; top--)
+    {
+      if (top == 0)
+      {
+        grid_copy (g, &stack[0].g);
+        return (k);
+      }
+      if (!level_hypothesis_pop (&stack[top - 1], &stack[top], k, stats)
+          && level_hypothesis_push (&stack[top - 1], &stack[top], stats))
+        break;
+      k = stack[top - 1].retCode;
+    }
   }
 }
 
 /////////////////////////////////////////////////////////////////////////
 ///////////////////////////////// BACKTRACKING METHOD ///////////////////
 /////////////////////////////////////////////////////////////////////////
-/// Construct event argument from an array.
+/// Construct a view of an array for handlers.
 /// @param[in] g array grid
-static sudoku_grid_event_args
-int9x9_print (int g[GRID_SIZE][GRID_SIZE])
+/// @returns view of the array, valid as long as the array is.
+static sudoku_grid_view
+int9x9_view (int g[GRID_SIZE][GRID_SIZE])
 {
   int nbc = 0;
 
@@ -1684,19 +2558,9 @@ int9x9_print (int g[GRID_SIZE][GRID_SIZE])
     if (g[i / GRID_SIZE][i % GRID_SIZE])
       nbc++;
 
-  sudoku_grid_event_args sudokuOnEventArgs;
-
-  for (int r = 0; r < GRID_SIZE; r++)
-    for (int c = 0; c < GRID_SIZE; c++)
-    {
-      sudokuOnEventArgs.grid[r][c][0] = g[r][c];
-      for (int v = 1; v < GRID_SIZE; v++)
-        sudokuOnEventArgs.grid[r][c][v] = 0;
-    }
+  sudoku_grid_view view = { 0, g, nbc };
 
-  sudokuOnEventArgs.nbCells = nbc;
-
-  return (sudokuOnEventArgs);
+  return (view);
 }
 
 /// Check that the grid is valid.
@@ -1734,81 +2598,250 @@ int9x9_check (int g[GRID_SIZE][GRID_SIZE])
   return 1;
 }
 
-/// Solves a grid using backtracking.
-/// @param[in] id Grid idenitifier
-/// @param[in] g array grid
-/// @param[in] find \c FIRST to find the first solution or \c ALL to find all solutions
-/// @param[out] stats Statistic data
-/// @return 1 if some candidates have been excluded, 0 otherwise, -1 if g is invalide
-static int
-int9x9_solveByBacktracking (uintptr_t id, int g[GRID_SIZE][GRID_SIZE], findSolutions find, counters * stats)
+/// Returns the next number of a pseudo-random sequence (splitmix64).
+/// @param[in,out] state State of the sequence
+/// @return Pseudo-random number
+static uint64_t
+random_next (uint64_t * state)
+{
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/// State of a backtracking search.
+///
+/// The values used in each row, column and square are kept as bit masks, updated as cells are filled and emptied.
+typedef struct
+{
+  int g[GRID_SIZE][GRID_SIZE];  ///< Grid being filled
+  unsigned int row[GRID_SIZE];  ///< Bit masks of the values used in the rows
+  unsigned int column[GRID_SIZE];       ///< Bit masks of the values used in the columns
+  unsigned int square[GRID_SIZE];       ///< Bit masks of the values used in the squares
+  uintptr_t id;                 ///< Grid identifier
+  counters *stats;              ///< Statistic data
+} bitboard;
+
+/// Fills a cell of a backtracking search, or empties it.
+/// @param[in,out] b Backtracking search
+/// @param[in] l Line
+/// @param[in] c Column
+/// @param[in] bit Bit of the value to set in or remove from the cell
+static void
+bitboard_toggle (bitboard * b, int l, int c, unsigned int bit)
 {
-  int retCode = 0;
-  int ii;
+  b->row[l] ^= bit;
+  b->column[c] ^= bit;
+  b->square[SQUARE_SIZE * (l / SQUARE_SIZE) + c / SQUARE_SIZE] ^= bit;
+}
 
-  for (ii = 0; ii < GRID_SIZE * GRID_SIZE && g[ii / GRID_SIZE][ii % GRID_SIZE] != 0; ii++)
-    ;
+/// Finds the empty cell of a backtracking search with the fewest candidates.
+/// @param[in] b Backtracking search
+/// @param[out] candidates Candidates of the cell found
+/// @return Index of the cell found, -1 if the grid is complete, -2 if the grid can not be completed
+///
+/// If no cell has a single candidate left, a value which fits in only one cell of a region is looked for: this cell
+/// is returned with that value as single candidate.
+static int
+bitboard_pivot (const bitboard * b, unsigned int *candidates)
+{
+  const unsigned int all = (1U << GRID_SIZE) - 1;
+  unsigned int cell[GRID_SIZE * GRID_SIZE];
+  int ipivot = -1;
+  unsigned int min = GRID_SIZE + 1;
 
-  if (ii < GRID_SIZE * GRID_SIZE)
+  for (int i = 0; i < GRID_SIZE * GRID_SIZE && min > 1; i++)
   {
-    int l = ii / GRID_SIZE;
-    int c = ii % GRID_SIZE;
+    int l = i / GRID_SIZE;
+    int c = i % GRID_SIZE;
 
-    for (int value = 1; value <= GRID_SIZE; value++)
+    if (b->g[l][c])
     {
-      int skipValue = 0;
+      cell[i] = 0;
+      continue;
+    }
 
-      for (int cell = 0; cell < GRID_SIZE; cell++)
-        if (g[l][cell] == value || g[cell][c] == value
-            || g[SQUARE_SIZE * (l / SQUARE_SIZE) + cell / SQUARE_SIZE][SQUARE_SIZE * (c / SQUARE_SIZE) +
-                                                                       cell % SQUARE_SIZE] == value)
-          skipValue = 1;
+    unsigned int bits = all & ~(b->row[l] | b->column[c] | b->square[SQUARE_SIZE * (l / SQUARE_SIZE) + c / SQUARE_SIZE]);
+    unsigned int n = NB_BITS (bits);
 
-      if (!skipValue)
-      {
-        int clone[GRID_SIZE][GRID_SIZE];
+    cell[i] = bits;
+    if (n == 0)
+      return (-2);              // dead end
+    else if (n < min)
+    {
+      ipivot = i;
+      *candidates = bits;
+      min = n;
+    }
+  }
+
+  if (min <= 1)
+    return ipivot;
+
+  for (int ir = 0; ir < GRID_SIZE * 3; ir++)
+  {
+    const unsigned short *const r_cell = REGION_CELL[ir];
+    unsigned int once = 0, twice = 0;
+
+    for (int i = 0; i < GRID_SIZE; i++)
+    {
+      twice |= once & cell[r_cell[i]];
+      once |= cell[r_cell[i]];
+    }
 
-        memcpy (clone, g, GRID_SIZE * GRID_SIZE * sizeof (int));
-        clone[l][c] = value;
-        stats->backtrackingTries++;
-        int i = int9x9_solveByBacktracking (id, clone, find, stats);
+    unsigned int used = ir < GRID_SIZE ? b->row[ir] : ir < 2 * GRID_SIZE ? b->column[ir - GRID_SIZE] :
+      b->square[ir - 2 * GRID_SIZE];
+
+    if ((once | used) != all)
+      return (-2);              // dead end, a value fits nowhere in the region
+    else if (once & ~twice)
+    {
+      unsigned int bit = once & ~twice & -(once & ~twice);
 
-        if (i > 0)
+      for (int i = 0; i < GRID_SIZE; i++)
+        if (cell[r_cell[i]] & bit)
         {
-          retCode = 1;
-          if (find == FIRST)
-            return (1);         // don't go further the first solution found
+          *candidates = bit;
+          return r_cell[i];
         }
-      }
     }
-
-    //stats->nbSteps++;
-    return (retCode);
   }
-  else
+
+  return ipivot;
+}
+
+/// Searches for the solutions of a backtracking search, trying first the cell with the fewest candidates.
+/// @param[in,out] b Backtracking search, restored on return
+/// @return 1 if a solution has been found, 0 otherwise
+static int
+bitboard_solve (bitboard * b)
+{
+  unsigned int candidates = 0;
+  int ipivot = bitboard_pivot (b, &candidates);
+
+  if (ipivot == -2)
+    return (0);                 // dead end
+  else if (ipivot >= 0)
   {
-    stats->nbSolutions++;
-    char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
+    int retCode = 0;
+    int l = ipivot / GRID_SIZE;
+    int c = ipivot % GRID_SIZE;
+
+    for (unsigned int bits = candidates; bits; bits &= bits - 1)
+    {
+      unsigned int bit = bits & -bits;
+
+      if ((b->stats->cancel && atomic_load_explicit (b->stats->cancel, memory_order_relaxed))
+          || search_interrupted (b->stats))
+        break;
+
+      b->g[l][c] = __builtin_ctz (bit) + 1;
+      bitboard_toggle (b, l, c, bit);
+      b->stats->backtrackingTries++;
+      int i = bitboard_solve (b);
+
+      bitboard_toggle (b, l, c, bit);   // undo in place
+      b->g[l][c] = 0;
+
+      if (i > 0)
+      {
+        retCode = 1;
+        if (search_completed (b->stats))
+          return (1);           // don't go further the requested number of solutions
+      }
+    }
+
+    return (retCode);
+  }
+  else
+  {
+    counters *const stats = b->stats;
+
+    if (++stats->nbSolutions == 1)
+      memcpy (stats->solution, b->g, GRID_SIZE * GRID_SIZE * sizeof (int));
+
+    if (stats->ctx->sudokuOnMessageHandlers)
+    {
+      char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-    MESSAGE_APPEND (rule, _("Solved using backtracking method (solution #%i, %i tries).\n"), stats->nbSolutions,
-                    stats->backtrackingTries);
-    sudoku_on_message (id, get_message_args (rule, 0));
-    sudoku_on_solved (id, int9x9_print (g));
+      MESSAGE_APPEND (rule, _("Solved using backtracking method (solution #%i, %i tries).\n"), stats->nbSolutions,
+                      stats->backtrackingTries);
+      sudoku_on_message (stats->ctx, b->id, get_message_args (rule, 0));
+    }
+    sudoku_on_solved (stats->ctx, b->id, int9x9_view (b->g));
     return (1);
   }
 }
 
+/// Fills the empty cells of a backtracking search with random values.
+/// @param[in,out] b Backtracking search, left complete on success
+/// @param[in,out] rng State of the pseudo-random number generator
+/// @return 1 if the grid could be completed, 0 otherwise (the grid is then restored)
+static int
+bitboard_fill (bitboard * b, uint64_t * rng)
+{
+  unsigned int candidates = 0;
+  int ipivot = bitboard_pivot (b, &candidates);
+
+  if (ipivot == -2)
+    return (0);                 // dead end
+  else if (ipivot == -1)
+    return (1);                 // complete
+
+  int l = ipivot / GRID_SIZE;
+  int c = ipivot % GRID_SIZE;
+
+  while (candidates)
+  {
+    // Pick one of the remaining candidates at random.
+    unsigned int bit = candidates;
+
+    for (int k = random_next (rng) % NB_BITS (candidates); k > 0; k--)
+      bit &= bit - 1;
+    bit &= -bit;
+    candidates &= ~bit;
+
+    b->g[l][c] = __builtin_ctz (bit) + 1;
+    bitboard_toggle (b, l, c, bit);
+    if (bitboard_fill (b, rng))
+      return (1);
+    bitboard_toggle (b, l, c, bit);
+    b->g[l][c] = 0;
+  }
+
+  return (0);
+}
+
+/// Solves a grid using backtracking.
+/// @param[in] id Grid idenitifier
+/// @param[in] g array grid, valid
+/// @param[out] stats Statistic data
+/// @return 1 if a solution has been found, 0 otherwise
+static int
+int9x9_solveByBacktracking (uintptr_t id, int g[GRID_SIZE][GRID_SIZE], counters * stats)
+{
+  bitboard b = {.id = id,.stats = stats };
+
+  memcpy (b.g, g, GRID_SIZE * GRID_SIZE * sizeof (int));
+  for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+    if (g[i / GRID_SIZE][i % GRID_SIZE])
+      bitboard_toggle (&b, i / GRID_SIZE, i % GRID_SIZE, 1U << (g[i / GRID_SIZE][i % GRID_SIZE] - 1));
+
+  return bitboard_solve (&b);
+}
+
+static pthread_once_t sudokuInitOnce = PTHREAD_ONCE_INIT;
+static pthread_once_t sudokuNamesOnce = PTHREAD_ONCE_INIT;
+
 /// Initialize static data.
-void
-sudoku_init (void)
+static void
+sudoku_tables_init (void)
 {
   // Internationalization with gettext
   bindtextdomain (PACKAGE, "./po");
 
-  NB_BITS[0] = 0;
-  for (unsigned int i = 1; i < (1 << GRID_SIZE); i++)
-    NB_BITS[i] = (i & 1) + NB_BITS[i >> 1];
-
   for (int i = 0; i < GRID_SIZE; i++)
   {
     VALUE_NAME[i] = DIGIT[i];
@@ -1816,6 +2849,13 @@ sudoku_init (void)
     COLUMN_NAME[i] = tolower (ALPHABET[i + (GRID_SIZE <= 9 ? GRID_SIZE : 0)]);
   }
 
+  grid_topology_init ();
+}
+
+/// Initialize the localized names of regions and segments, needed by messages only.
+static void
+sudoku_names_build (void)
+{
   for (int r = 0; r < GRID_SIZE * 3; r++)       // 27 regions
   {
     regionType t = r / GRID_SIZE;
@@ -1858,44 +2898,108 @@ sudoku_init (void)
         break;
     }
   }
+}
 
-  unsigned int index = 0;
+void
+sudoku_init (void)
+{
+  pthread_once (&sudokuInitOnce, sudoku_tables_init);
+}
 
-  for (int i = 0; i <= GRID_SIZE; i++)
-  {
-    for (unsigned int j = 0; j < (1 << GRID_SIZE); j++)
-      if (NB_BITS[j] == i)
-      {
-        SUBSETS[index++] = j;
-        SUBSET_INDEX[i] = index;
-      }
-  }
+/// Initialize the names of regions and segments, once, when they are first needed.
+static void
+sudoku_names_init (void)
+{
+  sudoku_init ();
+  pthread_once (&sudokuNamesOnce, sudoku_names_build);
 }
 
 /////////////////////////////////////////////////////////////////////////
 ////////////////////////// EXACT COVER SEARCH METHOD ////////////////////
 /////////////////////////////////////////////////////////////////////////
 
+/// Number of subsets (candidate values of cells) of the exact cover matrix of a grid.
+#define EXACT_COVER_NB_SUBSETS (GRID_SIZE * GRID_SIZE * GRID_SIZE)
+/// Number of columns (constraints) of the exact cover matrix of a grid.
+#define EXACT_COVER_NB_COLUMNS (4 * GRID_SIZE * GRID_SIZE)
+
+/// Definition of the exact cover matrix of a grid, built once and shared by all grids.
+///
+/// Columns and subsets are named by integers: subset (r * GRID_SIZE + c) * GRID_SIZE + v stands for value v + 1 in
+/// cell (r, c) and covers the columns of the cell, of the value in the row, in the column and in the square.
+static struct
+{
+  char *columns;                ///< Names of the columns, separated by '|'
+  char *name[EXACT_COVER_NB_SUBSETS];   ///< Names of the subsets
+  char *subset[EXACT_COVER_NB_SUBSETS]; ///< Names of the columns covered by the subsets, separated by '|'
+} EXACT_COVER_MATRIX;
+
+static pthread_once_t exactCoverOnce = PTHREAD_ONCE_INIT;
+
+/// Builds the definition of the exact cover matrix of a grid.
+static void
+exact_cover_matrix_build (void)
+{
+  size_t width = snprintf (0, 0, "%i", EXACT_COVER_NB_COLUMNS) + 1;     // A name and its separator
+  char *p = malloc (width * (EXACT_COVER_NB_COLUMNS + 5 * EXACT_COVER_NB_SUBSETS) * sizeof (*p));
+
+  if (p == 0)
+  {
+    fprintf (stderr, _("Memory allocation error (%s, %s, %i)\n"), __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+
+  EXACT_COVER_MATRIX.columns = p;
+  for (int i = 0; i < EXACT_COVER_NB_COLUMNS; i++)
+    p += sprintf (p, i ? "|%i" : "%i", i);
+  p++;
+
+  for (int row = 0; row < GRID_SIZE; row++)
+    for (int column = 0; column < GRID_SIZE; column++)
+      for (int number = 0; number < GRID_SIZE; number++)
+      {
+        int i = (row * GRID_SIZE + column) * GRID_SIZE + number;
+
+        EXACT_COVER_MATRIX.name[i] = p;
+        p += sprintf (p, "%i", i) + 1;
+
+        EXACT_COVER_MATRIX.subset[i] = p;
+        p += sprintf (p, "%i|%i|%i|%i", row * GRID_SIZE + column,
+                      GRID_SIZE * GRID_SIZE + row * GRID_SIZE + number,
+                      2 * GRID_SIZE * GRID_SIZE + column * GRID_SIZE + number,
+                      3 * GRID_SIZE * GRID_SIZE + (SQUARE_SIZE * (row / SQUARE_SIZE) + column / SQUARE_SIZE) * GRID_SIZE +
+                      number) + 1;
+      }
+}
+
 /// Displayer function to be used by the exqct cover serach library libdlx.a.
 /// @see [dancing links library](https://github.com/farhiongit/dancing-links).
 static void
 exact_cover_search_solution_displayer (Universe head, unsigned long length, const char *const *solution, void *ptr)
 {
+  counters *stats = ptr;
+
   if (!length || !solution)
   {
-    sudoku_on_message ((uintptr_t) head, get_message_args (_("Grid is not valid.\n"), 0));
+    sudoku_on_message (stats->ctx, (uintptr_t) head, get_message_args (_("Grid is not valid.\n"), 0));
     return;
   }
 
   int g[GRID_SIZE][GRID_SIZE];
 
   for (unsigned long i = 0; i < length; i++)
-    if (solution[i] && strchr (DIGIT, solution[i][1]) && strchr (DIGIT, solution[i][3])
-        && strchr (DIGIT, solution[i][5]))
-      g[strchr (DIGIT, solution[i][1]) - DIGIT][strchr (DIGIT, solution[i][3]) - DIGIT] =
-        strchr (DIGIT, solution[i][5]) - DIGIT + 1;
+    if (solution[i])
+    {
+      int s = atoi (solution[i]);
 
-  sudoku_on_solved ((uintptr_t) head, int9x9_print (g));
+      if (s >= 0 && s < EXACT_COVER_NB_SUBSETS)
+        g[s / (GRID_SIZE * GRID_SIZE)][s / GRID_SIZE % GRID_SIZE] = s % GRID_SIZE + 1;
+    }
+
+  if (++stats->nbSolutions == 1)
+    memcpy (stats->solution, g, GRID_SIZE * GRID_SIZE * sizeof (int));
+
+  sudoku_on_solved (stats->ctx, (uintptr_t) head, int9x9_view (g));
 }
 
 /* Interface function */
@@ -1917,35 +3021,344 @@ sudoku_get_version (void)
       exit (-1);
     }
     snprintf (version, length, "V%s, %s %s", SUDOKU_SOLVE_VERSION, __DATE__, __TIME__);
-    sudoku_on_message (0, get_message_args (version, 0));
+    sudoku_on_message (&sudokuDefaultContext, 0, get_message_args (version, 0));
   }
   return version;
 }
 
+/// Fills in the outcome of a resolution.
+/// @param [out] result Outcome of the resolution, ignored if null
+/// @param [in] m Method effectively used
+/// @param [in] stats Statistic data
+/// @return m
+static method
+sudoku_result_set (sudoku_result * result, method m, const counters * stats)
+{
+  if (result)
+  {
+    result->method = m;
+    result->engine = stats ? stats->engine : NONE;
+    result->nbSolutions = stats ? stats->nbSolutions : 0;
+    result->nbHypotheses = stats ? stats->backtrackingTries : 0;
+    if (result->nbSolutions)
+      memcpy (result->solution, stats->solution, sizeof (result->solution));
+    result->depth = stats ? stats->backtrackingLevel : 0;
+    result->nbSteps = stats ? stats->backtrackingSteps : 0;
+    result->nbRules = stats ? stats->nbRules : 0;
+    for (int i = 0; i < GRID_SIZE; i++)
+    {
+      result->cellExclusions[i] = stats ? stats->rC[i] : 0;
+      result->candidateExclusions[i] = stats ? stats->rV[i] : 0;
+      result->valueExclusions[i] = stats ? stats->rR[i] : 0;
+    }
+    result->regionExclusions = stats ? stats->rI : 0;
+    result->status = stats ? stats->status : SEARCH_COMPLETE;
+  }
+  return m;
+}
+
 method
 sudoku_solve (int g[GRID_SIZE][GRID_SIZE], method method, findSolutions find)
 {
+  return sudoku_solve_result (g, method, find, 0);
+}
+
+method
+sudoku_solve_result (int g[GRID_SIZE][GRID_SIZE], method method, findSolutions find, sudoku_result * result)
+{
+  sudoku_init ();
+
+  return sudoku_solve_ctx (&sudokuDefaultContext, g, method, find, result);
+}
+
+method
+sudoku_solve_ctx (sudoku_context * ctx, int g[GRID_SIZE][GRID_SIZE], method method, findSolutions find,
+                  sudoku_result * result)
+{
+  return sudoku_solve_ctx_n (ctx, g, method, find == FIRST ? 1 : 0, result);
+}
+
+int
+sudoku_solve_n (int g[GRID_SIZE][GRID_SIZE], method method, int limit)
+{
+  sudoku_result result;
+
+  sudoku_init ();
+  sudoku_solve_ctx_n (&sudokuDefaultContext, g, method, limit, &result);
+  return result.nbSolutions;
+}
+
+method
+sudoku_solve_array (int startGrid[], method method, int limit, int solution[], int *nbSolutions)
+{
+  int g[GRID_SIZE][GRID_SIZE];
+  sudoku_result result;
+
+  memcpy (g, startGrid, sizeof (g));
   sudoku_init ();
+  method = sudoku_solve_ctx_n (&sudokuDefaultContext, g, method, limit, &result);
+  if (nbSolutions)
+    *nbSolutions = result.nbSolutions;
+  if (solution && result.nbSolutions)
+    memcpy (solution, result.solution, sizeof (result.solution));
+  return method;
+}
+
+/// Number of methods raced by the method AUTO.
+#define RACE_ENGINES_NB 2
+
+/// Engine of a race between methods.
+typedef struct
+{
+  struct race *race;            ///< Race of the engine
+  sudoku_context *ctx;          ///< Context of the engine, without handlers
+  int (*grid)[GRID_SIZE];       ///< Grid to be solved
+  method method;                ///< Method of the engine
+  int limit;                    ///< Number of solutions after which the search stops, 0 for no limit
+  int won;                      ///< 1 if the engine finished first
+  sudoku_result result;         ///< Result of the engine
+  unsigned long nbRuns;         ///< Number of races run by the thread of the engine
+  int threaded;                 ///< 1 if the engine runs on a thread of its own
+  pthread_t thread;             ///< Thread of the engine
+} race_engine;
+
+/// Engines raced by the method AUTO, kept with their contexts and threads by the context which races them.
+typedef struct race
+{
+  race_engine engines[RACE_ENGINES_NB]; ///< Engines, the first one run by the calling thread
+  atomic_int finished;          ///< Flag raised by the first engine to finish, which cancels the others
+  pthread_mutex_t mutex;        ///< Mutex of the fields below and of the runs of the engines
+  pthread_cond_t changed;       ///< Condition signaled when a race starts, an engine finishes or the race ends
+  unsigned long nbRaces;        ///< Number of races started
+  int quit;                     ///< 1 if the threads of the engines should end
+} race;
+
+/// Runs an engine in a race.
+/// @param [in,out] e Engine
+static void
+race_run (race_engine * e)
+{
+  int expected = 0;
+
+  sudoku_solve_ctx_n (e->ctx, e->grid, e->method, e->limit, &e->result);
+  e->won = atomic_compare_exchange_strong (&e->race->finished, &expected, 1);
+}
+
+/// Thread of an engine, running it in each race until the race ends.
+/// @param [in] arg Engine
+/// @return 0
+static void *
+race_thread (void *arg)
+{
+  race_engine *const e = arg;
+  race *const r = e->race;
+
+  pthread_mutex_lock (&r->mutex);
+  for (;;)
+  {
+    while (!r->quit && e->nbRuns == r->nbRaces)
+      pthread_cond_wait (&r->changed, &r->mutex);
+    if (r->quit)
+      break;
+    pthread_mutex_unlock (&r->mutex);
+    race_run (e);
+    pthread_mutex_lock (&r->mutex);
+    e->nbRuns++;
+    pthread_cond_broadcast (&r->changed);
+  }
+  pthread_mutex_unlock (&r->mutex);
+  return 0;
+}
+
+/// Creates the engines of a race, with their contexts and threads.
+/// @return The race, to be destroyed by race_destroy()
+static race *
+race_create (void)
+{
+  race *const r = calloc (1, sizeof (*r));
+
+  if (!r)
+  {
+    fprintf (stderr, _("Memory allocation error (%s, %s, %i)\n"), __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+  atomic_init (&r->finished, 0);
+  pthread_mutex_init (&r->mutex, 0);
+  pthread_cond_init (&r->changed, 0);
+  for (int i = 0; i < RACE_ENGINES_NB; i++)
+  {
+    race_engine *const e = &r->engines[i];
+
+    e->race = r;
+    e->method = i ? ELIMINATION : BACKTRACKING;
+    e->ctx = sudoku_context_create ();
+    e->ctx->cancel = &r->finished;
+    // The first engine races in the calling thread, the others in threads of their own (or after it if none is
+    // available).
+    e->threaded = i && !pthread_create (&e->thread, 0, race_thread, e);
+  }
+  return r;
+}
+
+/// Ends the threads of the engines of a race and destroys them.
+/// @param [in] r Race, or null
+static void
+race_destroy (race * r)
+{
+  if (!r)
+    return;
+
+  pthread_mutex_lock (&r->mutex);
+  r->quit = 1;
+  pthread_cond_broadcast (&r->changed);
+  pthread_mutex_unlock (&r->mutex);
+  for (int i = 0; i < RACE_ENGINES_NB; i++)
+  {
+    if (r->engines[i].threaded)
+      pthread_join (r->engines[i].thread, 0);
+    sudoku_context_destroy (r->engines[i].ctx);
+  }
+  pthread_cond_destroy (&r->changed);
+  pthread_mutex_destroy (&r->mutex);
+  free (r);
+}
+
+/// Solves a grid with the fastest of the elimination and backtracking methods.
+/// @param [in] ctx Context
+/// @param [in] g Grid
+/// @param [in] limit Number of solutions after which the search stops, 0 for no limit
+/// @param [out] result Outcome of the winner of the race, ignored if null
+/// @return The method effectively used by the winner
+///
+/// Both methods are raced on threads of their own, and the loser is cancelled as soon as the winner finishes.
+/// The engines, their contexts and their threads are kept by the context for the next races.
+/// The exact cover search, which can not be cancelled, does not race.
+/// Handlers are not expected to be called from several threads: if any is set in the context, or if a single
+/// processor is online, one method is picked instead, the elimination method for grids with many givens.
+static method
+sudoku_solve_auto (sudoku_context * ctx, int g[GRID_SIZE][GRID_SIZE], int limit, sudoku_result * result)
+{
+  if (ctx->sudokuOnInitEventHandlers || ctx->sudokuOnChangeEventHandlers || ctx->sudokuOnSolvedEventHandlers
+      || ctx->sudokuOnMessageHandlers || sysconf (_SC_NPROCESSORS_ONLN) < 2)
+  {
+    int nbGivens = 0;
+
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+      nbGivens += g[i / GRID_SIZE][i % GRID_SIZE] != 0;
+    return sudoku_solve_ctx_n (ctx, g, nbGivens >= GRID_SIZE * GRID_SIZE / 3 ? ELIMINATION : BACKTRACKING, limit,
+                               result);
+  }
+
+  if (!ctx->race)
+    ctx->race = race_create ();
+
+  race *const r = ctx->race;
+
+  atomic_store (&r->finished, 0);
+  for (int i = 0; i < RACE_ENGINES_NB; i++)
+  {
+    race_engine *const e = &r->engines[i];
+
+    e->ctx->subsetDepth = ctx->subsetDepth;
+    e->ctx->tiered = ctx->tiered;
+    e->ctx->schedule = ctx->schedule;
+    e->ctx->limits = ctx->limits;
+    e->ctx->interrupt = ctx->interrupt ? ctx->interrupt : &ctx->cancelled;
+    e->grid = g;
+    e->limit = limit;
+    e->won = 0;
+  }
+
+  pthread_mutex_lock (&r->mutex);
+  r->nbRaces++;
+  pthread_cond_broadcast (&r->changed);
+  pthread_mutex_unlock (&r->mutex);
+  race_run (&r->engines[0]);
+  for (int i = 1; i < RACE_ENGINES_NB; i++)
+    if (r->engines[i].threaded)
+    {
+      pthread_mutex_lock (&r->mutex);
+      while (r->engines[i].nbRuns != r->nbRaces)
+        pthread_cond_wait (&r->changed, &r->mutex);
+      pthread_mutex_unlock (&r->mutex);
+    }
+    else
+      race_run (&r->engines[i]);
+
+  race_engine *winner = &r->engines[0];
+
+  for (int i = 1; i < RACE_ENGINES_NB; i++)
+    if (r->engines[i].won)
+      winner = &r->engines[i];
+
+  ctx->stats = winner->ctx->stats;
+  ctx->stats.ctx = ctx;
+  ctx->stats.cancel = ctx->cancel;
+  ctx->stats.stack = ctx->stack;
+  if (result)
+    *result = winner->result;
 
+  return winner->result.method;
+}
+
+static method cache_solve (sudoku_context * ctx, int g[GRID_SIZE][GRID_SIZE], method method, int limit,
+                           sudoku_result * result);
+
+method
+sudoku_solve_ctx_n (sudoku_context * ctx, int g[GRID_SIZE][GRID_SIZE], method method, int limit,
+                    sudoku_result * result)
+{
   for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
     if (g[i / GRID_SIZE][i % GRID_SIZE] < 0 || g[i / GRID_SIZE][i % GRID_SIZE] > GRID_SIZE)
     {
-      if (sudokuOnMessageHandlers)
+      if (ctx->sudokuOnMessageHandlers)
       {
         char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
         MESSAGE_APPEND (rule, _("Grid is not valid.\n"));
-        sudoku_on_message (0, get_message_args (rule, 0));
+        sudoku_on_message (ctx, 0, get_message_args (rule, 0));
       }
-      return (NONE);
+      return sudoku_result_set (result, NONE, 0);
     }
 
-  counters theStats;
+  // Handlers are only called by actual resolutions.
+  if (ctx->cache && !ctx->sudokuOnInitEventHandlers && !ctx->sudokuOnChangeEventHandlers &&
+      !ctx->sudokuOnSolvedEventHandlers && !ctx->sudokuOnMessageHandlers)
+    return cache_solve (ctx, g, method, limit, result);
+
+  if (method == AUTO)
+    return sudoku_solve_auto (ctx, g, limit, result);
 
-  theStats.nbSolutions = theStats.nbRules = theStats.backtrackingLevel =
-    theStats.backtrackingSteps = theStats.backtrackingTries = theStats.rI = 0;
+  counters *const stats = &ctx->stats;
+
+  stats->ctx = ctx;
+  stats->nbSolutions = stats->nbRules = stats->backtrackingLevel =
+    stats->backtrackingSteps = stats->backtrackingTries = stats->rI = 0;
   for (int i = 0; i < GRID_SIZE; i++)
-    theStats.rC[i] = theStats.rV[i] = 0;
+    stats->rC[i] = stats->rV[i] = stats->rR[i] = 0;
+#ifdef SUDOKU_PROFILE
+  memset (stats->profile, 0, sizeof (stats->profile));
+#endif
+  // Handlers are not expected to be called from several threads.
+  stats->parallelDepth = ctx->sudokuOnInitEventHandlers || ctx->sudokuOnChangeEventHandlers ||
+    ctx->sudokuOnSolvedEventHandlers || ctx->sudokuOnMessageHandlers ? 0 : ctx->parallelDepth;
+  stats->found = 0;
+  stats->limit = limit > 0 ? limit : 0;
+  stats->cancel = ctx->cancel;
+  stats->cancelled = ctx->interrupt ? ctx->interrupt : &ctx->cancelled;
+  stats->maxTries = ctx->limits.maxHypotheses > 0 ? ctx->limits.maxHypotheses : 0;
+  stats->deadline = ctx->limits.timeout > 0 ? clock_now () + (long long) (ctx->limits.timeout * 1e9) : 0;
+  stats->clockPeriod = method == BACKTRACKING ? 255 : 0;       // tries are much cheaper than hypotheses
+  stats->nbChecks = 0;
+  stats->status = SEARCH_COMPLETE;
+  stats->engine = method;
+  stats->subsetDepth = ctx->subsetDepth > 0 && ctx->subsetDepth < GRID_SIZE ? ctx->subsetDepth : GRID_SIZE;
+  stats->tiered = ctx->tiered;
+  stats->schedule = ctx->schedule;
+  if (stats->schedule.regionDepth <= 0 || (unsigned int) stats->schedule.regionDepth > stats->subsetDepth)
+    stats->schedule.regionDepth = stats->subsetDepth;
+  if (stats->schedule.valueDepth <= 0 || (unsigned int) stats->schedule.valueDepth > stats->subsetDepth)
+    stats->schedule.valueDepth = stats->subsetDepth;
 
   // USING ELIMINATION METHOD
   if (method == ELIMINATION)
@@ -1953,64 +3366,76 @@ sudoku_solve (int g[GRID_SIZE][GRID_SIZE], method method, findSolutions find)
     // the sudoku grid to solve
     grid theGridCells;
 
-    grid_init_from_int9x9 (&theGridCells, g);
+    grid_init_from_int9x9 (&theGridCells, g, stats);
 
-    if (sudokuOnInitEventHandlers)
-      sudoku_on_init (theGridCells.id, get_event_args (&theGridCells));
+    // The stack of the search is never deeper than the number of cells.
+    if (!ctx->stack && !(ctx->stack = malloc ((GRID_SIZE * GRID_SIZE + 1) * sizeof (*ctx->stack))))
+    {
+      fprintf (stderr, _("Memory allocation error (%s, %s, %i)\n"), __func__, __FILE__, __LINE__);
+      exit (-1);
+    }
+    stats->stack = ctx->stack;
+
+    if (ctx->sudokuOnInitEventHandlers)
+      sudoku_on_init (ctx, stats->gridId, grid_view (&theGridCells));
 
     // Solve
-    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
-      theStats.theSolution[i][0] = 0;
+    if (ctx->sudokuOnMessageHandlers)
+      memset (stats->steps, 0, sizeof (stats->steps));
 
     // Searching for solutions.
-    int ret = grid_solveByElimination (&theGridCells, find, &theStats);
+    int ret = grid_solveByElimination (&theGridCells, stats);
 
     // Clean after yourself
 
     if (ret < 0)
     {
-      if (sudokuOnMessageHandlers)
+      if (ctx->sudokuOnMessageHandlers)
       {
         char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-        MESSAGE_APPEND (rule, _("Grid is not valid.\n"));
-        sudoku_on_message (theGridCells.id, get_message_args (rule, 0));
+        if (stats->status != SEARCH_COMPLETE)
+          MESSAGE_APPEND (rule, "%s", search_status_message (stats->status));
+        else
+          MESSAGE_APPEND (rule, _("Grid is not valid.\n"));
+        sudoku_on_message (ctx, stats->gridId, get_message_args (rule, 0));
       }
-      ret = 0;
+      return sudoku_result_set (result, NONE, stats);
     }
     else
     {
       ret = 1;
-      if (sudokuOnMessageHandlers)
+      if (ctx->sudokuOnMessageHandlers)
       {
         char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-        MESSAGE_APPEND (rule, ngettext ("%i solution found.\n", "%i solutions found.\n", theStats.nbSolutions),
-                        theStats.nbSolutions);
-        MESSAGE_APPEND (rule, _("Solved with %i rules and %i hypothesis.\n"), theStats.nbRules,
-                        theStats.backtrackingTries);
+        MESSAGE_APPEND (rule, "%s", search_status_message (stats->status));
+        MESSAGE_APPEND (rule, ngettext ("%i solution found.\n", "%i solutions found.\n", stats->nbSolutions),
+                        stats->nbSolutions);
+        MESSAGE_APPEND (rule, _("Solved with %i rules and %i hypothesis.\n"), stats->nbRules,
+                        stats->backtrackingTries);
         MESSAGE_APPEND (rule, _("Cell Exclusion:\n"));
         for (int i = GRID_SIZE; i > 0; i--)
-          if (theStats.rC[i - 1] > 0)
-            MESSAGE_APPEND (rule, _("\tDepth %i: %i\n"), i, theStats.rC[i - 1]);
+          if (stats->rC[i - 1] > 0)
+            MESSAGE_APPEND (rule, _("\tDepth %i: %i\n"), i, stats->rC[i - 1]);
         MESSAGE_APPEND (rule, _("Candidate Exclusion:\n"));
         for (int i = GRID_SIZE; i > 0; i--)
-          if (theStats.rV[i - 1] > 0)
-            MESSAGE_APPEND (rule, _("\tDepth %i: %i\n"), i, theStats.rV[i - 1]);
+          if (stats->rV[i - 1] > 0)
+            MESSAGE_APPEND (rule, _("\tDepth %i: %i\n"), i, stats->rV[i - 1]);
         MESSAGE_APPEND (rule, _("Value Exclusion:\n"));
         for (int i = GRID_SIZE; i > 0; i--)
-          if (theStats.rR[i - 1] > 0)
-            MESSAGE_APPEND (rule, _("\tDepth %i: %i\n"), i, theStats.rR[i - 1]);
+          if (stats->rR[i - 1] > 0)
+            MESSAGE_APPEND (rule, _("\tDepth %i: %i\n"), i, stats->rR[i - 1]);
         MESSAGE_APPEND (rule, _("Regions Exclusion:\n"));
-        MESSAGE_APPEND (rule, _("\t%i\n"), theStats.rI);
+        MESSAGE_APPEND (rule, _("\t%i\n"), stats->rI);
         MESSAGE_APPEND (rule, _("Backtracking:\n"));
-        MESSAGE_APPEND (rule, _("\tDepth: %i\n"), theStats.backtrackingLevel);
-        MESSAGE_APPEND (rule, _("\tSteps: %i\n"), theStats.backtrackingSteps);
-        MESSAGE_APPEND (rule, _("\tHypothesis: %i\n"), theStats.backtrackingTries);
-        sudoku_on_message (theGridCells.id, get_message_args (rule, 0));
+        MESSAGE_APPEND (rule, _("\tDepth: %i\n"), stats->backtrackingLevel);
+        MESSAGE_APPEND (rule, _("\tSteps: %i\n"), stats->backtrackingSteps);
+        MESSAGE_APPEND (rule, _("\tHypothesis: %i\n"), stats->backtrackingTries);
+        sudoku_on_message (ctx, stats->gridId, get_message_args (rule, 0));
       }
     }
-    return (theStats.backtrackingTries ? BACKTRACKING : ELIMINATION);
+    return sudoku_result_set (result, stats->backtrackingTries ? BACKTRACKING : ELIMINATION, stats);
   }
 
   // USING BACKTRACKING METHOD
@@ -2018,125 +3443,971 @@ sudoku_solve (int g[GRID_SIZE][GRID_SIZE], method method, findSolutions find)
   {
     uintptr_t gridID = (uintptr_t) g;
 
-    sudoku_on_init (gridID, int9x9_print (g));
+    sudoku_on_init (ctx, gridID, int9x9_view (g));
 
     // Searching for solutions.
-    if (int9x9_check (g) == 0 || int9x9_solveByBacktracking (gridID, g, find, &theStats) == 0)
+    if (int9x9_check (g) == 0 || int9x9_solveByBacktracking (gridID, g, stats) == 0)
     {
-      sudoku_on_message (gridID, get_message_args (_("Grid is not valid.\n"), 0));
-      return (NONE);
+      sudoku_on_message (ctx, gridID, get_message_args (stats->status != SEARCH_COMPLETE ?
+                                                        search_status_message (stats->status) :
+                                                        _("Grid is not valid.\n"), 0));
+      return sudoku_result_set (result, NONE, stats);
     }
     else
-      return (BACKTRACKING);
+    {
+      if (stats->status != SEARCH_COMPLETE)
+        sudoku_on_message (ctx, gridID, get_message_args (search_status_message (stats->status), 0));
+      return sudoku_result_set (result, BACKTRACKING, stats);
+    }
   }
 
   // USING EXACT COVER METHOD
   else if (method == EXACT_COVER)
   {
-    char cell[] = "R?C?#?";
-    char inCell[] = "R?C?";
-    char inRow[] = "R?#?";
-    char inColumn[] = "C?#?";
-    char inBox[] = "B?#?";
-
-    // Initialize the columns of the matrix to be covered exactly.
-    char columns[strlen (inCell) * (GRID_SIZE * GRID_SIZE) + (GRID_SIZE * GRID_SIZE) +
-                 strlen (inRow) * (GRID_SIZE * GRID_SIZE) + (GRID_SIZE * GRID_SIZE) +
-                 strlen (inColumn) * (GRID_SIZE * GRID_SIZE) + (GRID_SIZE * GRID_SIZE) +
-                 strlen (inBox) * (GRID_SIZE * GRID_SIZE) + (GRID_SIZE * GRID_SIZE) + 1];
-    *columns = 0;
-    for (int i = 1; i <= GRID_SIZE; i++)
-      for (int j = 1; j <= GRID_SIZE; j++)
-      {
-        inCell[1] = DIGIT[i - 1];
-        inCell[3] = DIGIT[j - 1];
-        strcat (columns, inCell);
-        strcat (columns, "|");
-
-        inRow[1] = DIGIT[i - 1];
-        inRow[3] = DIGIT[j - 1];
-        strcat (columns, inRow);
-        strcat (columns, "|");
-
-        inColumn[1] = DIGIT[i - 1];
-        inColumn[3] = DIGIT[j - 1];
-        strcat (columns, inColumn);
-        strcat (columns, "|");
-
-        inBox[1] = DIGIT[i - 1];
-        inBox[3] = DIGIT[j - 1];
-        strcat (columns, inBox);
-        strcat (columns, "|");
-      }
+    pthread_once (&exactCoverOnce, exact_cover_matrix_build);
 
     // Initialize a matrix to be covered exactly.
-    Universe sudoku = dlx_universe_create (columns, "|");
+    Universe sudoku = dlx_universe_create (EXACT_COVER_MATRIX.columns, "|");
 
-    dlx_displayer_set (sudoku, exact_cover_search_solution_displayer, 0);
-    //(void) (exact_cover_search_solution_displayer);
+    dlx_displayer_set (sudoku, exact_cover_search_solution_displayer, stats);
 
-    sudoku_on_init ((uintptr_t) sudoku, int9x9_print (g));
+    sudoku_on_init (ctx, (uintptr_t) sudoku, int9x9_view (g));
 
     // Initialize the lines of the matrix to be covered exactly.
-    char line[strlen (inCell) + 1 + strlen (inRow) + 1 + strlen (inColumn) + 1 + strlen (inBox) + 1];
-
-    for (int row = 1; row <= GRID_SIZE; row++)
-      for (int column = 1; column <= GRID_SIZE; column++)
-        for (int number = 1; number <= GRID_SIZE; number++)
-        {
-          cell[1] = DIGIT[row - 1];
-          cell[3] = DIGIT[column - 1];
-          cell[5] = DIGIT[number - 1];
-
-          *line = 0;
-          inCell[1] = DIGIT[row - 1];
-          inCell[3] = DIGIT[column - 1];
-          strcat (line, inCell);
-          strcat (line, "|");
-
-          inRow[1] = DIGIT[row - 1];
-          inRow[3] = DIGIT[number - 1];
-          strcat (line, inRow);
-          strcat (line, "|");
-
-          inColumn[1] = DIGIT[column - 1];
-          inColumn[3] = DIGIT[number - 1];
-          strcat (line, inColumn);
-          strcat (line, "|");
-
-          inBox[1] = DIGIT[SQUARE_SIZE * ((row - 1) / SQUARE_SIZE) + (column - 1) / SQUARE_SIZE];
-          inBox[3] = DIGIT[number - 1];
-          strcat (line, inBox);
-
-          dlx_subset_define (sudoku, cell, line, "|");
-        }
+    for (int i = 0; i < EXACT_COVER_NB_SUBSETS; i++)
+      dlx_subset_define (sudoku, EXACT_COVER_MATRIX.name[i], EXACT_COVER_MATRIX.subset[i], "|");
 
     // Initialize the already covered lines of the matrix to be covered exactly
     // using the initial sudoku grid (g).
-    for (int row = 1; row <= GRID_SIZE; row++)
-      for (int column = 1; column <= GRID_SIZE; column++)
-        if (g[row - 1][column - 1])
+    for (int row = 0; row < GRID_SIZE; row++)
+      for (int column = 0; column < GRID_SIZE; column++)
+        if (g[row][column]
+            && !dlx_subset_require_in_solution (sudoku,
+                                                EXACT_COVER_MATRIX.name[(row * GRID_SIZE + column) * GRID_SIZE +
+                                                                        g[row][column] - 1]))
         {
-          cell[1] = DIGIT[row - 1];
-          cell[3] = DIGIT[column - 1];
-          cell[5] = DIGIT[g[row - 1][column - 1] - 1];
-          if (!dlx_subset_require_in_solution (sudoku, cell))
-          {
-            sudoku_on_message ((uintptr_t) sudoku, get_message_args (_("Grid is not valid.\n"), 0));
-            return (NONE);
-          }
+          sudoku_on_message (ctx, (uintptr_t) sudoku, get_message_args (_("Grid is not valid.\n"), 0));
+          dlx_universe_destroy (sudoku);
+          return sudoku_result_set (result, NONE, stats);
         }
 
     // Searching for solutions covering exactly the matrix.
-    char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
-    unsigned long nbsol = dlx_exact_cover_search (sudoku, find == FIRST ? 1 : 0);
+    // The library offers no way to interrupt its search: the limits are only checked before it starts.
+    unsigned long nbsol = search_interrupted (stats) ? 0 : dlx_exact_cover_search (sudoku, stats->limit);
+
+    if (ctx->sudokuOnMessageHandlers)
+    {
+      char rule[SUDOKU_MAX_MESSAGE_LENGTH] = "";
 
-    MESSAGE_APPEND (rule, ngettext ("%i solution found.\n", "%i solutions found.\n", nbsol), nbsol);
-    MESSAGE_APPEND (rule, _("Solved using exact cover search method.\n"));
-    sudoku_on_message ((uintptr_t) sudoku, get_message_args (rule, 0));
+      MESSAGE_APPEND (rule, "%s", search_status_message (stats->status));
+      MESSAGE_APPEND (rule, ngettext ("%i solution found.\n", "%i solutions found.\n", nbsol), nbsol);
+      MESSAGE_APPEND (rule, _("Solved using exact cover search method.\n"));
+      sudoku_on_message (ctx, (uintptr_t) sudoku, get_message_args (rule, 0));
+    }
 
     // Freeing all.
     dlx_universe_destroy (sudoku);
+
+    return sudoku_result_set (result, nbsol ? EXACT_COVER : NONE, stats);
+  }
+  return sudoku_result_set (result, NONE, 0);
+}
+
+/////////////////////////////////////////////////////////////////////////
+///////////////////////////////// RESULT CACHE //////////////////////////
+/////////////////////////////////////////////////////////////////////////
+
+/// Transformation of a grid into its canonical form.
+typedef struct
+{
+  unsigned short cell[GRID_SIZE * GRID_SIZE];   ///< Cell of the grid moved to each cell of the canonical form
+  unsigned char value[GRID_SIZE + 1];   ///< Value of the canonical form of each value of the grid, 0 for 0
+  unsigned char grid[GRID_SIZE * GRID_SIZE];    ///< Canonical form of the grid
+} canonical;
+
+/// Entry of a cache of results.
+typedef struct
+{
+  unsigned char grid[GRID_SIZE * GRID_SIZE];    ///< Canonical form of the grid
+  method method;                ///< Method selected for solving the grid
+  int limit;                    ///< Number of solutions after which the search stopped, 0 for no limit
+  uint64_t hash;                ///< Hash of the grid, the method and the limit
+  sudoku_result result;         ///< Outcome of the resolution, the solution being in canonical form
+  int next;                     ///< Next entry of the same bucket, -1 if none
+  int older;                    ///< Entry used less recently, -1 if none
+  int newer;                    ///< Entry used more recently, -1 if none
+} cache_entry;
+
+/// Definition of a cache of results.
+///
+/// Entries are chained in the buckets of a hash table, and in the order of their last use.
+struct sudoku_cache
+{
+  pthread_mutex_t mutex;        ///< Lock of the cache, shared by contexts
+  int capacity;                 ///< Maximum number of entries
+  int nbEntries;                ///< Number of entries
+  int nbBuckets;                ///< Number of buckets, a power of 2
+  int *buckets;                 ///< First entry of each bucket, -1 if none
+  cache_entry *entries;         ///< Entries
+  int newest;                   ///< Entry used most recently, -1 if none
+  int oldest;                   ///< Entry used least recently, -1 if none
+  long long hits;               ///< Number of lookups found
+  long long misses;             ///< Number of lookups not found
+};
+
+sudoku_cache *
+sudoku_cache_create (int capacity)
+{
+  sudoku_cache *const cache = calloc (1, sizeof (*cache));
+
+  if (capacity < 1)
+    capacity = 1;
+  if (cache)
+  {
+    cache->capacity = capacity;
+    for (cache->nbBuckets = 1; cache->nbBuckets < capacity; cache->nbBuckets *= 2)
+      /* nothing */ ;
+    cache->buckets = malloc (cache->nbBuckets * sizeof (*cache->buckets));
+    cache->entries = malloc (capacity * sizeof (*cache->entries));
+  }
+  if (!cache || !cache->buckets || !cache->entries || pthread_mutex_init (&cache->mutex, 0))
+  {
+    fprintf (stderr, _("Memory allocation error (%s, %s, %i)\n"), __func__, __FILE__, __LINE__);
+    exit (-1);
+  }
+  for (int i = 0; i < cache->nbBuckets; i++)
+    cache->buckets[i] = -1;
+  cache->newest = cache->oldest = -1;
+  return cache;
+}
+
+void
+sudoku_cache_destroy (sudoku_cache * cache)
+{
+  if (!cache)
+    return;
+
+  pthread_mutex_destroy (&cache->mutex);
+  free (cache->entries);
+  free (cache->buckets);
+  free (cache);
+}
+
+void
+sudoku_cache_counters_get (sudoku_cache * cache, sudoku_cache_counters * counters)
+{
+  pthread_mutex_lock (&cache->mutex);
+  counters->hits = cache->hits;
+  counters->misses = cache->misses;
+  counters->nbEntries = cache->nbEntries;
+  counters->capacity = cache->capacity;
+  pthread_mutex_unlock (&cache->mutex);
+}
+
+/// Index of a cell of a grid, possibly transposed.
+/// @param [in] transposed 1 if the grid is transposed
+/// @param [in] row Row of the cell in the (possibly transposed) grid
+/// @param [in] column Column of the cell in the (possibly transposed) grid
+/// @return Index of the cell in the grid
+static int
+canonical_cell (int transposed, int row, int column)
+{
+  return transposed ? column * GRID_SIZE + row : row * GRID_SIZE + column;
+}
+
+/// Mixes the bits of a key (step of splitmix64).
+/// @param [in] key Key
+/// @return Mixed key
+static uint64_t
+canonical_mix (uint64_t key)
+{
+  key += 0x9e3779b97f4a7c15ULL;
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+  return key ^ (key >> 31);
+}
+
+/// Orders the rows (or columns) of a grid band by band, bands and rows within a band by increasing key.
+/// @param [in] key Keys of the rows
+/// @param [out] order Rows of the grid, in canonical order
+///
+/// The order is stable: rows (or bands) with the same key keep their order.
+static void
+canonical_order (const uint64_t key[GRID_SIZE], int order[GRID_SIZE])
+{
+  uint64_t bandKey[SQUARE_SIZE] = { 0 };
+  int bands[SQUARE_SIZE];
+
+  for (int i = 0; i < GRID_SIZE; i++)
+    bandKey[i / SQUARE_SIZE] += key[i];
+
+  // Insertion sorts
+  for (int b = 0; b < SQUARE_SIZE; b++)
+  {
+    int j = b;
+
+    for (; j > 0 && bandKey[bands[j - 1]] > bandKey[b]; j--)
+      bands[j] = bands[j - 1];
+    bands[j] = b;
   }
-  return (NONE);
+  for (int b = 0; b < SQUARE_SIZE; b++)
+    for (int r = 0; r < SQUARE_SIZE; r++)
+    {
+      int row = bands[b] * SQUARE_SIZE + r;
+      int j = b * SQUARE_SIZE + r;
+
+      for (; j > b * SQUARE_SIZE && key[order[j - 1]] > key[row]; j--)
+        order[j] = order[j - 1];
+      order[j] = row;
+    }
+}
+
+/// Computes the canonical form of a grid.
+/// @param [in] g Grid
+/// @param [out] c Canonical form, and the transformation leading to it
+///
+/// Rows, columns and values get keys which only depend on the structure of the givens: each key is refined, round after
+/// round, from the keys of the rows, columns and values it shares givens with. Those keys are invariant by the
+/// transformations preserving solutions. For both orientations of the grid, bands, stacks, rows and columns are then
+/// ordered by increasing key, values are renumbered in the order they first appear, row by row, and the smallest of both
+/// forms is kept. Equivalent grids therefore get the same form unless rows or columns tie; ties only cost hits, as forms
+/// are compared exactly and the transformation is inverted exactly.
+static void
+grid_canonical (int g[GRID_SIZE][GRID_SIZE], canonical * c)
+{
+  const int *const cells = &g[0][0];
+  uint64_t rowKey[GRID_SIZE] = { 0 };
+  uint64_t columnKey[GRID_SIZE] = { 0 };
+  uint64_t valueKey[GRID_SIZE + 1] = { 0 };
+
+  for (int round = 0; round < 3; round++)
+  {
+    uint64_t rows[GRID_SIZE] = { 0 };
+    uint64_t columns[GRID_SIZE] = { 0 };
+    uint64_t values[GRID_SIZE + 1] = { 0 };
+
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+      if (cells[i])
+      {
+        int row = i / GRID_SIZE, column = i % GRID_SIZE, value = cells[i];
+
+        rows[row] += canonical_mix (columnKey[column] + 3 * valueKey[value]);
+        columns[column] += canonical_mix (rowKey[row] + 3 * valueKey[value]);
+        values[value] += canonical_mix (rowKey[row] ^ columnKey[column]);
+      }
+    memcpy (rowKey, rows, sizeof (rowKey));
+    memcpy (columnKey, columns, sizeof (columnKey));
+    memcpy (valueKey, values, sizeof (valueKey));
+  }
+
+  for (int transposed = 0; transposed < 2; transposed++)
+  {
+    int rows[GRID_SIZE];
+    int columns[GRID_SIZE];
+
+    canonical_order (transposed ? columnKey : rowKey, rows);
+    canonical_order (transposed ? rowKey : columnKey, columns);
+
+    canonical t;
+    int nbValues = 0;
+
+    memset (t.value, 0, sizeof (t.value));
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+    {
+      int value = cells[t.cell[i] = canonical_cell (transposed, rows[i / GRID_SIZE], columns[i % GRID_SIZE])];
+
+      if (value && !t.value[value])
+        t.value[value] = ++nbValues;
+      t.grid[i] = t.value[value];
+    }
+    // Values absent from the grid
+    for (int value = 1; value <= GRID_SIZE; value++)
+      if (!t.value[value])
+        t.value[value] = ++nbValues;
+
+    if (!transposed || memcmp (t.grid, c->grid, sizeof (t.grid)) < 0)
+      *c = t;
+  }
+}
+
+/// Hashes the key of an entry of a cache (FNV-1a).
+/// @param [in] c Canonical form of the grid
+/// @param [in] method Method selected for solving the grid
+/// @param [in] limit Number of solutions after which the search stops
+/// @return Hash
+static uint64_t
+cache_hash (const canonical * c, method method, int limit)
+{
+  uint64_t hash = 0xcbf29ce484222325ULL;
+
+  for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+    hash = (hash ^ c->grid[i]) * 0x100000001b3ULL;
+  hash = (hash ^ (uint64_t) method) * 0x100000001b3ULL;
+  return (hash ^ (uint64_t) limit) * 0x100000001b3ULL;
+}
+
+/// Detaches an entry from the order of use of a cache.
+/// @param [in,out] cache Cache
+/// @param [in] e Entry
+static void
+cache_unlink (sudoku_cache * cache, int e)
+{
+  cache_entry *const entry = &cache->entries[e];
+
+  if (entry->newer >= 0)
+    cache->entries[entry->newer].older = entry->older;
+  else
+    cache->newest = entry->older;
+  if (entry->older >= 0)
+    cache->entries[entry->older].newer = entry->newer;
+  else
+    cache->oldest = entry->newer;
+}
+
+/// Makes an entry the most recently used of a cache.
+/// @param [in,out] cache Cache
+/// @param [in] e Entry, detached from the order of use
+static void
+cache_link (sudoku_cache * cache, int e)
+{
+  cache_entry *const entry = &cache->entries[e];
+
+  entry->newer = -1;
+  entry->older = cache->newest;
+  if (cache->newest >= 0)
+    cache->entries[cache->newest].newer = e;
+  else
+    cache->oldest = e;
+  cache->newest = e;
+}
+
+/// Looks an entry up in a cache.
+/// @param [in] cache Cache, locked
+/// @param [in] c Canonical form of the grid
+/// @param [in] method Method selected for solving the grid
+/// @param [in] limit Number of solutions after which the search stops
+/// @param [in] hash Hash of the key
+/// @return Entry, -1 if not found
+static int
+cache_find (const sudoku_cache * cache, const canonical * c, method method, int limit, uint64_t hash)
+{
+  for (int e = cache->buckets[hash & (cache->nbBuckets - 1)]; e >= 0; e = cache->entries[e].next)
+  {
+    const cache_entry *const entry = &cache->entries[e];
+
+    if (entry->hash == hash && entry->method == method && entry->limit == limit
+        && !memcmp (entry->grid, c->grid, sizeof (entry->grid)))
+      return e;
+  }
+  return -1;
+}
+
+/// Inserts an entry in a cache, evicting the least recently used one if the cache is full.
+/// @param [in,out] cache Cache, locked
+/// @param [in] c Canonical form of the grid
+/// @param [in] method Method selected for solving the grid
+/// @param [in] limit Number of solutions after which the search stopped
+/// @param [in] hash Hash of the key
+/// @param [in] result Outcome of the resolution, the solution being in canonical form
+static void
+cache_insert (sudoku_cache * cache, const canonical * c, method method, int limit, uint64_t hash,
+              const sudoku_result * result)
+{
+  int e;
+
+  if (cache->nbEntries < cache->capacity)
+    e = cache->nbEntries++;
+  else
+  {
+    e = cache->oldest;
+    cache_unlink (cache, e);
+
+    int *pe = &cache->buckets[cache->entries[e].hash & (cache->nbBuckets - 1)];
+
+    while (*pe != e)
+      pe = &cache->entries[*pe].next;
+    *pe = cache->entries[e].next;
+  }
+
+  cache_entry *const entry = &cache->entries[e];
+  int *const bucket = &cache->buckets[hash & (cache->nbBuckets - 1)];
+
+  memcpy (entry->grid, c->grid, sizeof (entry->grid));
+  entry->method = method;
+  entry->limit = limit;
+  entry->hash = hash;
+  entry->result = *result;
+  entry->next = *bucket;
+  *bucket = e;
+  cache_link (cache, e);
+}
+
+/// Solves the sudoku grid within a context, through the cache of the context.
+/// @param [in] ctx Context, with a cache
+/// @param [in] g Grid to be solved
+/// @param [in] method Method selected for solving the grid
+/// @param [in] limit Number of solutions after which the search stops, 0 for no limit
+/// @param [out] result Outcome of the resolution, ignored if null
+/// @return The method effectively used to solve the grid, as cached.
+static method
+cache_solve (sudoku_context * ctx, int g[GRID_SIZE][GRID_SIZE], method method, int limit, sudoku_result * result)
+{
+  sudoku_cache *const cache = ctx->cache;
+  canonical c;
+
+  grid_canonical (g, &c);
+  if (limit < 0)
+    limit = 0;
+
+  uint64_t hash = cache_hash (&c, method, limit);
+  sudoku_result r;
+  int e;
+
+  pthread_mutex_lock (&cache->mutex);
+  if ((e = cache_find (cache, &c, method, limit, hash)) >= 0)
+  {
+    cache_unlink (cache, e);
+    cache_link (cache, e);
+    r = cache->entries[e].result;
+    cache->hits++;
+  }
+  else
+    cache->misses++;
+  pthread_mutex_unlock (&cache->mutex);
+
+  if (e >= 0)
+  {
+    if (result)
+    {
+      // Back from the canonical form
+      unsigned char value[GRID_SIZE + 1];
+      int solution[GRID_SIZE * GRID_SIZE];
+
+      for (int v = 0; v <= GRID_SIZE; v++)
+        value[c.value[v]] = v;
+      if (r.nbSolutions)
+      {
+        for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+          solution[c.cell[i]] = value[(&r.solution[0][0])[i]];
+        memcpy (r.solution, solution, sizeof (r.solution));
+      }
+      else
+        memset (r.solution, 0, sizeof (r.solution));
+      *result = r;
+    }
+    return r.method;
+  }
+
+  sudoku_result *const solved = result ? result : &r;
+
+  ctx->cache = 0;
+  sudoku_solve_ctx_n (ctx, g, method, limit, solved);
+  ctx->cache = cache;
+
+  // To the canonical form
+  sudoku_result entry = *solved;
+
+  if (entry.nbSolutions)
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+      (&entry.solution[0][0])[i] = c.value[(&solved->solution[0][0])[c.cell[i]]];
+
+  // An interrupted resolution may not tell the same next time.
+  if (solved->status != SEARCH_COMPLETE)
+    return solved->method;
+
+  pthread_mutex_lock (&cache->mutex);
+  // Another context may have solved the same grid meanwhile.
+  if (cache_find (cache, &c, method, limit, hash) < 0)
+    cache_insert (cache, &c, method, limit, hash, &entry);
+  pthread_mutex_unlock (&cache->mutex);
+
+  return solved->method;
+}
+
+/////////////////////////////////////////////////////////////////////////
+///////////////////////////////// LANE-PARALLEL PROPAGATION /////////////
+/////////////////////////////////////////////////////////////////////////
+
+#if SUDOKU_SIZE <= 4
+/// Number of grids propagated together, one per lane of a vector.
+#  define LANES_NB 16
+
+/// Candidates of a cell of each of the grids propagated together (bit v-1 set if value v is possible).
+///
+/// The operations on these vectors are mapped by the compiler to the widest vector instructions of the target
+/// (AVX2 or AVX-512 if enabled, e.g. by -march=native), or to scalar instructions.
+/// They are never passed by value, so that the calling convention does not depend on the instructions enabled.
+typedef uint16_t lanes_mask __attribute__ ((vector_size (LANES_NB * sizeof (uint16_t))));
+
+/// Grids propagated together.
+typedef struct
+{
+  lanes_mask cell[GRID_SIZE * GRID_SIZE];       ///< Candidates of the cells
+  lanes_mask invalid;           ///< All bits set in the lanes where a contradiction was found
+} lanes;
+
+/// Tells whether any lane of a vector is not zero.
+/// @param [in] m Vector
+/// @return 1 if a lane is not zero, 0 otherwise
+static int
+lanes_any (const lanes_mask * m)
+{
+  for (int k = 0; k < LANES_NB; k++)
+    if ((*m)[k])
+      return 1;
+  return 0;
+}
+
+/// Applies the rules on singles to a region of all the grids at once.
+/// @param [in,out] l Grids
+/// @param [in] r Region
+/// @param [in,out] changed Vector to which the candidates eliminated are added
+///
+/// The values of the cells with a single candidate are eliminated from the other cells of the region (naked singles),
+/// and a cell holding the only place of a value in the region is set to that value (hidden singles).
+static void
+lanes_region_skim (lanes * l, int r, lanes_mask * changed)
+{
+  const lanes_mask none = { 0 };
+  const lanes_mask all = none + (uint16_t) ((1U << GRID_SIZE) - 1);
+  lanes_mask solved = none;     // values of the cells with a single candidate
+  lanes_mask twice = none;      // values possible in two cells at least
+  lanes_mask once = none;       // values possible in one cell at least
+  lanes_mask invalid = none;
+
+  for (int c = 0; c < GRID_SIZE; c++)
+  {
+    const lanes_mask m = l->cell[REGION_CELL[r][c]];
+    const lanes_mask single = (lanes_mask) ((m & (m - 1)) == 0) & m;
+
+    invalid |= solved & single; // a value in two cells
+    solved |= single;
+    twice |= once & m;
+    once |= m;
+  }
+  invalid |= once ^ all;        // a value possible nowhere
+
+  const lanes_mask hidden = once & ~twice;
+
+  for (int c = 0; c < GRID_SIZE; c++)
+  {
+    const int i = REGION_CELL[r][c];
+    const lanes_mask m = l->cell[i];
+    const lanes_mask single = (lanes_mask) ((m & (m - 1)) == 0);
+    lanes_mask n = (m & single) | (m & ~solved & ~single);
+    const lanes_mask h = n & hidden;
+    const lanes_mask found = (lanes_mask) (h != 0);
+
+    invalid |= (lanes_mask) ((h & (h - 1)) != 0);       // the only place of two values
+    n = (h & found) | (n & ~found);
+    invalid |= (lanes_mask) (n == 0);
+    *changed |= n ^ m;
+    l->cell[i] = n;
+  }
+  l->invalid |= (lanes_mask) (invalid != 0);
+}
+
+/// Applies the rules on singles to all the grids at once, until none applies any longer.
+/// @param [in,out] l Grids
+static void
+lanes_propagate (lanes * l)
+{
+  for (;;)
+  {
+    lanes_mask changed = { 0 };
+
+    for (int r = 0; r < GRID_SIZE * 3; r++)
+      lanes_region_skim (l, r, &changed);
+    changed &= ~l->invalid;
+    if (!lanes_any (&changed))
+      return;
+  }
+}
+#endif
+
+/////////////////////////////////////////////////////////////////////////
+///////////////////////////////// BATCH SOLVER //////////////////////////
+/////////////////////////////////////////////////////////////////////////
+
+/// Definition of a worker of the batch solver.
+///
+/// Each worker owns a range of grids, packed in one atomic word (first grid in the low half, end of the range in the
+/// high half), so that the worker can pop grids from the front of its range while idle workers steal the back half.
+typedef struct
+{
+  _Atomic uint64_t range;       ///< Range [first, end) of grids still to be solved by the worker
+  pthread_t thread;             ///< Thread of the worker
+  struct batch *batch;          ///< Batch the worker belongs to
+  int index;                    ///< Index of the worker within the batch
+} batch_worker;
+
+/// Definition of a batch of grids to be solved or generated.
+typedef struct batch
+{
+  int (*task) (struct batch * b, sudoku_context * ctx, uint32_t i);     ///< Task run on the i-th item, returns the number of successes
+  int (*grids)[GRID_SIZE][GRID_SIZE];   ///< Grids to be solved
+  method method;                ///< Method selected for solving the grids
+  findSolutions find;           ///< \c FIRST to find the first solution or \c ALL to find all solutions
+  sudoku_result *results;       ///< Outcomes of the resolutions, in the order of the grids
+  sudoku_puzzle *puzzles;       ///< Puzzles to be generated
+  uint64_t seed;                ///< Seed of the pseudo-random sequences of the generated puzzles
+  int grade;                    ///< Non-zero if the generated puzzles are to be graded
+  int nbWorkers;                ///< Number of workers
+  batch_worker *workers;        ///< Workers
+  _Atomic int nbSolved;         ///< Number of grids for which the task succeeded
+  sudoku_cache *cache;          ///< Cache of results of the workers, or null
+  sudoku_limits limits;         ///< Limits of the resolutions of the workers
+  const atomic_int *cancelled;  ///< Flag stopping the resolutions of the workers, or null
+  int nbGrids;                  ///< Number of grids to be solved
+  uint32_t *pending;            ///< Grids left to the method selected by the propagation in lanes
+  _Atomic uint32_t nbPending;   ///< Number of grids left to the method selected
+} batch;
+
+/// Packs a range of grids.
+/// @param [in] first First grid of the range
+/// @param [in] end End of the range
+/// @return packed range
+static uint64_t
+batch_range (uint32_t first, uint32_t end)
+{
+  return ((uint64_t) end << 32) | first;
+}
+
+/// Pops the first grid of the range of a worker.
+/// @param [in,out] w Worker
+/// @param [out] index Index of the grid popped
+/// @return 1 if a grid was popped, 0 if the range of the worker is empty
+static int
+batch_pop (batch_worker * w, uint32_t * index)
+{
+  uint64_t r = atomic_load (&w->range);
+  uint32_t first, end;
+
+  do
+  {
+    first = (uint32_t) r;
+    end = (uint32_t) (r >> 32);
+    if (first >= end)
+      return 0;
+  }
+  while (!atomic_compare_exchange_weak (&w->range, &r, batch_range (first + 1, end)));
+
+  *index = first;
+  return 1;
+}
+
+/// Steals the back half of the range of another worker.
+/// @param [in,out] w Idle worker, which range is empty
+/// @return 1 if some grids were stolen, 0 if all the other workers have nothing left to share
+static int
+batch_steal (batch_worker * w)
+{
+  for (int i = 1; i < w->batch->nbWorkers; i++)
+  {
+    batch_worker *const victim = &w->batch->workers[(w->index + i) % w->batch->nbWorkers];
+    uint64_t r = atomic_load (&victim->range);
+    uint32_t first, end, middle;
+
+    do
+    {
+      first = (uint32_t) r;
+      end = (uint32_t) (r >> 32);
+      if (first >= end)
+        break;
+      middle = first + (end - first) / 2;       // the back half, rounded up, is stolen
+    }
+    while (!atomic_compare_exchange_weak (&victim->range, &r, batch_range (first, middle)));
+
+    if (first < end)
+    {
+      atomic_store (&w->range, batch_range (middle, end));
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/// Thread of a worker of the batch solver.
+/// @param [in] arg Worker
+/// @return 0
+static void *
+batch_work (void *arg)
+{
+  batch_worker *const w = arg;
+  batch *const b = w->batch;
+  sudoku_context *const ctx = sudoku_context_create ();
+  uint32_t i;
+
+  sudoku_context_cache_set (ctx, b->cache);
+  ctx->limits = b->limits;
+  ctx->interrupt = b->cancelled;
+  do
+  {
+    while (batch_pop (w, &i))
+      atomic_fetch_add (&b->nbSolved, b->task (b, ctx, i));
+  }
+  while (batch_steal (w));
+
+  sudoku_context_destroy (ctx);
+  return 0;
+}
+
+/// Solves a grid of a batch.
+/// @param [in,out] b Batch
+/// @param [in] ctx Context of the worker
+/// @param [in] i Index of the grid
+/// @return 1 if a solution was found, 0 otherwise
+static int
+batch_solve (batch * b, sudoku_context * ctx, uint32_t i)
+{
+  return sudoku_solve_ctx (ctx, b->grids[i], b->method, b->find, &b->results[i]) != NONE;
+}
+
+#if SUDOKU_SIZE <= 4
+/// Solves a group of grids of a batch by the propagation of singles in lanes.
+/// @param [in,out] b Batch
+/// @param [in] ctx Context of the worker
+/// @param [in] group Index of the group of LANES_NB grids
+/// @return The number of grids for which a solution was found
+///
+/// The grids which the propagation neither completes nor invalidates are left to the method selected.
+static int
+batch_propagate (batch * b, sudoku_context * ctx, uint32_t group)
+{
+  const int first = group * LANES_NB;
+  const int nb = b->nbGrids - first < LANES_NB ? b->nbGrids - first : LANES_NB;
+  const lanes_mask none = { 0 };
+  lanes_mask unfit = none;      // lanes left to the method selected anyway
+  lanes l = {.invalid = none };
+
+  for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+    for (int k = 0; k < LANES_NB; k++)
+    {
+      int v = k < nb ? b->grids[first + k][i / GRID_SIZE][i % GRID_SIZE] : 0;
+
+      if (v < 0 || v > GRID_SIZE)
+        unfit[k] = 1;           // invalid grid, to be reported by the method selected
+      l.cell[i][k] = v > 0 && v <= GRID_SIZE ? 1U << (v - 1) : (1U << GRID_SIZE) - 1;
+    }
+
+  // A cancelled batch leaves its grids to the method selected, which reports the cancellation.
+  if (!ctx->interrupt || !atomic_load_explicit (ctx->interrupt, memory_order_relaxed))
+    lanes_propagate (&l);
+  else
+    unfit = none + 1;
+
+  int nbSolved = 0;
+
+  for (int k = 0; k < nb; k++)
+  {
+    sudoku_result *const result = &b->results[first + k];
+    int complete = 1;
+
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE && complete; i++)
+      complete = !(l.cell[i][k] & (l.cell[i][k] - 1));
+    if (unfit[k] || (!l.invalid[k] && !complete))
+    {
+      b->pending[atomic_fetch_add (&b->nbPending, 1)] = first + k;
+      continue;
+    }
+
+    // As the elimination method would tell, without any hypothesis (the counters of the rules are not kept).
+    memset (result, 0, sizeof (*result));
+    result->engine = ELIMINATION;
+    result->status = SEARCH_COMPLETE;
+    if (l.invalid[k])
+      result->method = NONE;
+    else
+    {
+      result->method = ELIMINATION;
+      result->nbSolutions = 1;
+      for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+        result->solution[i / GRID_SIZE][i % GRID_SIZE] = __builtin_ctz (l.cell[i][k]) + 1;
+      nbSolved++;
+    }
+  }
+  return nbSolved;
+}
+
+/// Solves a grid of a batch left by the propagation in lanes.
+/// @param [in,out] b Batch
+/// @param [in] ctx Context of the worker
+/// @param [in] i Index of the grid among those left
+/// @return 1 if a solution was found, 0 otherwise
+static int
+batch_solve_pending (batch * b, sudoku_context * ctx, uint32_t i)
+{
+  return batch_solve (b, ctx, b->pending[i]);
+}
+#endif
+
+/// Runs the task of a batch on its grids, with a pool of threads.
+/// @param [in,out] b Batch
+/// @param [in] nbGrids Number of grids
+/// @param [in] nbThreads Number of threads to use (the calling thread included), 0 for as many as online processors
+/// @return The number of grids for which the task succeeded
+static int
+batch_run (batch * b, int nbGrids, int nbThreads)
+{
+  sudoku_init ();
+
+  if (nbThreads <= 0)
+    nbThreads = sysconf (_SC_NPROCESSORS_ONLN);
+  if (nbThreads > nbGrids)
+    nbThreads = nbGrids;
+  if (nbThreads <= 0)
+    return 0;
+
+  batch_worker workers[nbThreads];
+
+  b->nbWorkers = nbThreads;
+  b->workers = workers;
+  atomic_init (&b->nbSolved, 0);
+
+  // Grids are first evenly shared between workers, which then balance the load by stealing.
+  for (int i = 0; i < nbThreads; i++)
+  {
+    workers[i].batch = b;
+    workers[i].index = i;
+    atomic_init (&workers[i].range,
+                 batch_range ((uint32_t) ((int64_t) nbGrids * i / nbThreads),
+                              (uint32_t) ((int64_t) nbGrids * (i + 1) / nbThreads)));
+  }
+
+  // The calling thread acts as the first worker.
+  for (int i = 1; i < nbThreads; i++)
+    if (pthread_create (&workers[i].thread, 0, batch_work, &workers[i]))
+    {
+      fprintf (stderr, _("Unexpected error (%s, %s, %i).\n"), __func__, __FILE__, __LINE__);
+      exit (-1);
+    }
+  batch_work (&workers[0]);
+  for (int i = 1; i < nbThreads; i++)
+    pthread_join (workers[i].thread, 0);
+
+  return atomic_load (&b->nbSolved);
+}
+
+int
+sudoku_solve_batch (int grids[][GRID_SIZE][GRID_SIZE], int nbGrids, method method, findSolutions find, int nbThreads,
+                    sudoku_result results[])
+{
+  batch b = {.task = batch_solve,.grids = grids,.method = method,.find = find,.results = results,
+    .cache = sudokuDefaultContext.cache,.limits = sudokuDefaultContext.limits,.cancelled =
+      &sudokuDefaultContext.cancelled,.nbGrids = nbGrids
+  };
+
+#if SUDOKU_SIZE <= 4
+  // The grids solved by singles alone are solved in lanes first, the others by the method selected afterwards.
+  if ((method == ELIMINATION || method == AUTO) && nbGrids > 0)
+  {
+    if (!(b.pending = malloc (nbGrids * sizeof (*b.pending))))
+    {
+      fprintf (stderr, _("Memory allocation error (%s, %s, %i)\n"), __func__, __FILE__, __LINE__);
+      exit (-1);
+    }
+    b.task = batch_propagate;
+    atomic_init (&b.nbPending, 0);
+
+    int nbSolved = batch_run (&b, (nbGrids + LANES_NB - 1) / LANES_NB, nbThreads);
+
+    b.task = batch_solve_pending;
+    nbSolved += batch_run (&b, atomic_load (&b.nbPending), nbThreads);
+    free (b.pending);
+    return nbSolved;
+  }
+#endif
+  return batch_run (&b, nbGrids, nbThreads);
+}
+
+/////////////////////////////////////////////////////////////////////////
+///////////////////////////////// GENERATOR /////////////////////////////
+/////////////////////////////////////////////////////////////////////////
+
+/// Grades the difficulty of the last resolution of a grid by elimination.
+/// @param [in] stats Statistic data of the resolution
+/// @return Grade, as described by sudoku_generate_batch()
+static int
+generator_grade (const counters * stats)
+{
+  if (stats->backtrackingTries)
+    return GRID_SIZE + stats->backtrackingTries;
+
+  int grade = stats->rI ? 2 : 1;
+
+  for (int i = GRID_SIZE; i > grade; i--)
+    if (stats->rC[i - 1] || stats->rV[i - 1] || stats->rR[i - 1])
+      return i;
+  return grade;
+}
+
+/// Generates a puzzle of a batch.
+/// @param [in,out] b Batch
+/// @param [in] ctx Context of the worker
+/// @param [in] i Index of the puzzle
+/// @return 1
+///
+/// A random complete grid is drawn, then its cells are emptied one by one, in a random order, as long as the solution
+/// remains unique. The puzzle is therefore minimal: none of its givens can be removed.
+/// The pseudo-random sequence of a puzzle only depends on the seed of the batch and the index of the puzzle.
+static int
+batch_generate (batch * b, sudoku_context * ctx, uint32_t i)
+{
+  sudoku_puzzle *const p = &b->puzzles[i];
+  uint64_t rng = b->seed + i * 0x9e3779b97f4a7c15ULL;
+  counters *const stats = &ctx->stats;
+  bitboard board = {.stats = stats };
+
+  stats->ctx = ctx;
+  while (!bitboard_fill (&board, &rng))
+    /* nothing */ ;
+  memcpy (p->grid, board.g, sizeof (p->grid));
+  p->nbGivens = GRID_SIZE * GRID_SIZE;
+
+  int order[GRID_SIZE * GRID_SIZE];
+
+  for (int j = 0; j < GRID_SIZE * GRID_SIZE; j++)
+  {
+    int k = random_next (&rng) % (j + 1);
+
+    order[j] = order[k];
+    order[k] = j;
+  }
+
+  for (int j = 0; j < GRID_SIZE * GRID_SIZE; j++)
+  {
+    int *const cell = &p->grid[order[j] / GRID_SIZE][order[j] % GRID_SIZE];
+    int value = *cell;
+
+    *cell = 0;
+    stats->nbSolutions = stats->backtrackingTries = 0;
+    stats->limit = 2;
+    stats->found = 0;
+    if (int9x9_solveByBacktracking (0, p->grid, stats) && stats->nbSolutions == 1)
+      p->nbGivens--;
+    else
+      *cell = value;            // the given is needed for the solution to be unique
+  }
+
+  if (b->grade)
+  {
+    sudoku_solve_ctx_n (ctx, p->grid, ELIMINATION, 2, &p->result);
+    p->grade = generator_grade (stats);
+  }
+  else
+  {
+    p->result.method = NONE;
+    p->result.nbSolutions = p->result.nbHypotheses = 0;
+    p->grade = 0;
+  }
+
+  return 1;
+}
+
+int
+sudoku_generate_batch (sudoku_puzzle puzzles[], int nbPuzzles, unsigned long seed, int grade, int nbThreads)
+{
+  batch b = {.task = batch_generate,.puzzles = puzzles,.seed = seed,.grade = grade };
+
+  return batch_run (&b, nbPuzzles, nbThreads);
 }
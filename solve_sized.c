@@ -0,0 +1,57 @@
+/**
+ * @file
+ * Sudoku solver for grids of any size, from a single library.
+ */
+
+/***********************************************************************************
+* Author: Laurent Farhi                                                            *
+* Name: solve_sized.c                                                              *
+* Language: C                                                                      *
+* Copyright (C) 2009, All rights reserved.                                         *
+*                                                                                  *
+* LICENSE:                                                                         *
+* This program is free software; you can redistribute it and/or modify             *
+* it under the terms of the GNU General Public License as published by             *
+* the Free Software Foundation; either version 2 of the License, or                *
+* (at your option) any later version.                                              *
+*                                                                                  *
+* This program is distributed in the hope that it will be useful,                  *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of                   *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                    *
+* GNU General Public License for more details.                                     *
+*                                                                                  *
+* You should have received a copy of the GNU General Public License                *
+* along with this program; if not, write to the Free Software                      *
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA       *
+***********************************************************************************/
+
+#include "solve_sized.h"
+
+/// Declares the entry point of the library of a given size.
+#define SUDOKU_SIZED_DECLARE(size) \
+  method sudoku_solve_array_##size (int startGrid[], method selected_method, int limit, int solution[], int *nbSolutions)
+
+SUDOKU_SIZED_DECLARE (2);
+SUDOKU_SIZED_DECLARE (3);
+SUDOKU_SIZED_DECLARE (4);
+SUDOKU_SIZED_DECLARE (5);
+
+method
+sudoku_solve_sized (int size, int startGrid[], method selected_method, int limit, int solution[], int *nbSolutions)
+{
+  switch (size)
+  {
+    case 2:
+      return sudoku_solve_array_2 (startGrid, selected_method, limit, solution, nbSolutions);
+    case 3:
+      return sudoku_solve_array_3 (startGrid, selected_method, limit, solution, nbSolutions);
+    case 4:
+      return sudoku_solve_array_4 (startGrid, selected_method, limit, solution, nbSolutions);
+    case 5:
+      return sudoku_solve_array_5 (startGrid, selected_method, limit, solution, nbSolutions);
+    default:
+      if (nbSolutions)
+        *nbSolutions = 0;
+      return NONE;
+  }
+}
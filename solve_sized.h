@@ -0,0 +1,48 @@
+/**
+ * @file
+ * Sudoku solver for grids of any size, from a single library.
+ */
+
+/***********************************************************************************
+* Author: Laurent Farhi                                                            *
+* Name: solve_sized.h                                                              *
+* Language: C                                                                      *
+* Copyright (C) 2009, All rights reserved.                                         *
+*                                                                                  *
+* LICENSE:                                                                         *
+* This program is free software; you can redistribute it and/or modify             *
+* it under the terms of the GNU General Public License as published by             *
+* the Free Software Foundation; either version 2 of the License, or                *
+* (at your option) any later version.                                              *
+*                                                                                  *
+* This program is distributed in the hope that it will be useful,                  *
+* but WITHOUT ANY WARRANTY; without even the implied warranty of                   *
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the                    *
+* GNU General Public License for more details.                                     *
+*                                                                                  *
+* You should have received a copy of the GNU General Public License                *
+* along with this program; if not, write to the Free Software                      *
+* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA       *
+***********************************************************************************/
+
+#pragma once
+#ifndef SUDOKU_SOLVE_SIZED_H
+#define SUDOKU_SOLVE_SIZED_H
+#include "solve.h"              // for method, which does not depend on the size
+
+/// Solves a sudoku grid of a size chosen at runtime.
+/// @param [in] size Size of the squares of the grid, from 2 (4x4 grids) to 5 (25x25 grids)
+/// @param [in] startGrid Grid to be solved, (size * size)^2 values row by row, 0 for an empty cell
+/// @param [in] selected_method Method selected for solving the grid
+/// @param [in] limit Number of solutions after which the search stops, 0 for no limit
+/// @param [out] solution First solution found ((size * size)^2 values), ignored if null
+/// @param [out] nbSolutions Number of solutions found, exact up to the limit, ignored if null
+/// @returns The method effectively used to solve the grid, #NONE if the size is not supported.
+///
+/// The library libsolve_sized.a gathers solve_mask.c compiled once per size with SUDOKU_SIZED defined
+/// (public symbols are then suffixed by the size, e.g. sudoku_solve_array_4) and dispatches to the one of the
+/// requested size.
+method sudoku_solve_sized (int size, int startGrid[], method selected_method, int limit, int solution[],
+                           int *nbSolutions);
+
+#endif
@@ -26,12 +26,19 @@
 * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA       *
 ***********************************************************************************/
 
+#define _XOPEN_SOURCE
+#define _BSD_SOURCE
+#define _DEFAULT_SOURCE
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
 #include <ctype.h>
 #include <termios.h>
 #include <unistd.h>
 #include <signal.h>
+#include <time.h>
+#include <sys/ioctl.h>
 #include "solve.h"
 #include "terminal.h"
 
@@ -41,56 +48,270 @@ static display sudokuDisplay;
 /// Flag indicating that a user input is required before proceeding.
 static int askAgain = 1;
 
+/// Maximum number of characters of a frame of the grid.
+#define FRAME_SIZE ((GRID_SIZE * (SQUARE_SIZE + 1) + 8) * (GRID_SIZE * (SQUARE_SIZE + 1) + 8))
+
+/// Period (in nanoseconds) within which the changes of a grid are drawn once on a terminal, unless interactive.
+#define FRAME_PERIOD 40000000LL
+
+/// Text of a frame of the grid, built before being written at once.
+typedef struct
+{
+  char text[FRAME_SIZE];        ///< Text of the frame, lines ended by a newline
+  int length;                   ///< Length of the text
+} frame;
+
+/// Output to the terminal, escape sequences included, built before being written at once.
+typedef struct
+{
+  char text[4 * FRAME_SIZE];    ///< Text
+  int length;                   ///< Length of the text
+} output;
+
+/// Flag indicating that the standard output is a terminal.
+static int onTerminal;
+
+/// Flag indicating the interactive mode.
+static int interactive;
+
+/// Frame pinned at the bottom of the terminal, below the region in which the other lines scroll.
+static struct
+{
+  int nbLines;                  ///< Number of lines of the frame, 0 if no frame is pinned
+  int rows;                     ///< Number of rows of the terminal
+  frame last;                   ///< Frame drawn
+  output o;                     ///< Output of the next drawing
+} pinned;
+
+/// Appends formatted text to a buffer, truncated if the buffer is full.
+/// @param [in,out] text Buffer
+/// @param [in] size Size of the buffer
+/// @param [in,out] length Length of the text in the buffer
+/// @param [in] format Format, as for printf()
+/// @param [in] args Arguments of the format
+static void
+text_add (char *text, int size, int *length, const char *format, va_list args)
+{
+  if (*length >= size)
+    return;
+
+  int n = vsnprintf (text + *length, size - *length, format, args);
+
+  *length = n < 0 ? *length : *length + n < size ? *length + n : size - 1;
+}
+
+/// Appends formatted text to a frame.
+/// @param [in,out] f Frame
+/// @param [in] format Format, as for printf()
+static void
+frame_add (frame * f, const char *format, ...)
+{
+  va_list args;
+
+  va_start (args, format);
+  text_add (f->text, sizeof (f->text), &f->length, format, args);
+  va_end (args);
+}
+
+/// Appends formatted text to an output.
+/// @param [in,out] o Output
+/// @param [in] format Format, as for printf()
+static void
+output_add (output * o, const char *format, ...)
+{
+  va_list args;
+
+  va_start (args, format);
+  text_add (o->text, sizeof (o->text), &o->length, format, args);
+  va_end (args);
+}
+
+/// Writes text to the standard output in one system call (as far as possible), after what printf() left pending.
+/// @param [in] text Text
+/// @param [in] length Length of the text
+static void
+output_write (const char *text, int length)
+{
+  fflush (stdout);
+  for (ssize_t n; length > 0; text += n, length -= n)
+    if ((n = write (STDOUT_FILENO, text, length)) < 0)
+      return;
+}
+
+/// Releases the bottom of the terminal, leaving the last frame drawn there.
+static void
+frame_unpin (void)
+{
+  if (!pinned.nbLines)
+    return;
+
+  char reset[32];
+  int n = snprintf (reset, sizeof (reset), "\033[r\033[%i;1H\n", pinned.rows);
+
+  output_write (reset, n);
+  pinned.nbLines = 0;
+}
+
+/// Releases the bottom of the terminal and ends the program, on interruption.
+/// @param [in] signum Signal
+static void
+frame_interrupted (int signum)
+{
+  static const char reset[] = "\033[r\n";
+
+  if (write (STDOUT_FILENO, reset, sizeof (reset) - 1) < 0)
+    _exit (-1);
+  _exit (128 + signum);
+}
+
+/// Pins a frame at the bottom of the terminal.
+/// @param [in] f Frame
+/// @param [in] nbLines Number of lines of the frame
+/// @param [in] rows Number of rows of the terminal
+static void
+frame_pin (const frame * f, int nbLines, int rows)
+{
+  output *const o = &pinned.o;
+
+  frame_unpin ();
+  o->length = 0;
+
+  // Room is made by scrolling up, then the lines above the frame become the scrolling region.
+  for (int y = 0; y < nbLines; y++)
+    output_add (o, "\n");
+  output_add (o, "\033[1;%ir", rows - nbLines);
+  for (int y = 0, x = 0; y < nbLines; y++, x++)
+  {
+    const char *eol = strchr (f->text + x, '\n');
+
+    output_add (o, "\033[%i;1H%.*s\033[K", rows - nbLines + 1 + y, (int) (eol - f->text - x), f->text + x);
+    x = eol - f->text;
+  }
+  output_add (o, "\033[%i;1H", rows - nbLines);
+  output_write (o->text, o->length);
+
+  if (!pinned.rows)
+    signal (SIGINT, frame_interrupted);
+  pinned.nbLines = nbLines;
+  pinned.rows = rows;
+  pinned.last = *f;
+}
+
+/// Shows a frame of the grid.
+/// @param [in] f Frame
+///
+/// On a terminal tall enough, the frame is pinned at the bottom and only the characters which changed since the frame
+/// drawn before are drawn again, at their position. Otherwise, the frame is written as is.
+static void
+frame_show (const frame * f)
+{
+  int nbLines = 0;
+  int width = 0;
+  struct winsize ws;
+
+  for (int i = 0, x = 0; i < f->length; i++, x++)
+    if (f->text[i] == '\n')
+    {
+      nbLines++;
+      if (x > width)
+        width = x;
+      x = -1;
+    }
+
+  if (!onTerminal || ioctl (STDOUT_FILENO, TIOCGWINSZ, &ws) || ws.ws_row < nbLines + 4 || ws.ws_col <= width)
+  {
+    frame_unpin ();
+    output_write (f->text, f->length);
+    return;
+  }
+  if (pinned.nbLines != nbLines || pinned.rows != ws.ws_row)
+  {
+    frame_pin (f, nbLines, ws.ws_row);
+    return;
+  }
+
+  output *const o = &pinned.o;
+  const char *a = pinned.last.text;
+  const char *b = f->text;
+
+  o->length = 0;
+  output_add (o, "\0337");      // the cursor of the scrolling region is saved
+  for (int y = 0; y < nbLines; y++)
+  {
+    const int la = strchr (a, '\n') - a;
+    const int lb = strchr (b, '\n') - b;
+
+    for (int x = 0; x < lb;)
+      if (x < la && a[x] == b[x])
+        x++;
+      else
+      {
+        // Runs of changes separated by less than the length of a move are drawn at once.
+        int end = x + 1;
+
+        for (int gap = 0; end + gap < lb && gap < 8;)
+          if (end + gap < la && a[end + gap] == b[end + gap])
+            gap++;
+          else
+          {
+            end += gap + 1;
+            gap = 0;
+          }
+        output_add (o, "\033[%i;%iH%.*s", pinned.rows - nbLines + 1 + y, x + 1, end - x, b + x);
+        x = end;
+      }
+    if (la > lb)
+      output_add (o, "\033[%i;%iH\033[K", pinned.rows - nbLines + 1 + y, lb + 1);
+    a += la + 1;
+    b += lb + 1;
+  }
+  output_add (o, "\0338");
+  if (o->length > 4)
+    output_write (o->text, o->length);
+  pinned.last = *f;
+}
+
 /// Event handler to display the sudoku grid.
 /// @param [in] id Grid identifier
-/// @param [in] evt_args Event to be processed
+/// @param [in] view Grid to be displayed
 static void
-grid_print (uintptr_t id, sudoku_grid_event_args evt_args)
+grid_print (uintptr_t id, const sudoku_grid_view * view)
 {
   static int nbCells;
   int ok[GRID_SIZE][GRID_SIZE];
+  const int viewNbCells = sudoku_grid_view_nb_cells (view);
 
   for (int l = 0; l < GRID_SIZE; l++)
     for (int c = 0; c < GRID_SIZE; c++)
-    {
-      ok[l][c] = 0;
-      for (int v = 0; v < GRID_SIZE; v++)
-        if (evt_args.grid[l][c][v])
-        {
-          if (!ok[l][c])
-            ok[l][c] = evt_args.grid[l][c][v];
-          else
-          {
-            ok[l][c] = 0;
-            break;
-          }
-        }
-    }
+      ok[l][c] = sudoku_grid_view_value (view, l, c);
 
   display d = 0;
+  static frame f;
+
+  f.length = 0;
 
   if (sudokuDisplay == RULES)
     d = RULES;
-  else if (nbCells && (evt_args.nbCells != GRID_SIZE * GRID_SIZE) && (sudokuDisplay & VERBOSE))
+  else if (nbCells && (viewNbCells != GRID_SIZE * GRID_SIZE) && (sudokuDisplay & VERBOSE))
     d = VERBOSE;
-  else if (!nbCells || (evt_args.nbCells == GRID_SIZE * GRID_SIZE)
-           || ((sudokuDisplay & NORMAL) && (evt_args.nbCells != nbCells)))
+  else if (!nbCells || (viewNbCells == GRID_SIZE * GRID_SIZE)
+           || ((sudokuDisplay & NORMAL) && (viewNbCells != nbCells)))
     d = NORMAL;
 
   if (d == VERBOSE)
   {
-    printf ("Grid #%u:\n", (unsigned int) id);
-    printf ("[%3i]", evt_args.nbCells);
+    frame_add (&f, "Grid #%u:\n", (unsigned int) id);
+    frame_add (&f, "[%3i]", viewNbCells);
     for (int i = 0; i < GRID_SIZE; i++)
     {
-      printf (" ");
+      frame_add (&f, " ");
       for (int j = 0; j < (SQUARE_SIZE - 1) / 2; j++)
-        printf (" ");
-      printf ("%c", sudoku_grid_referential.column_name[i]);
+        frame_add (&f, " ");
+      frame_add (&f, "%c", sudoku_grid_referential.column_name[i]);
       for (int j = 0; j < SQUARE_SIZE - (SQUARE_SIZE - 1) / 2 - 1; j++)
-        printf (" ");
+        frame_add (&f, " ");
     }
-    printf ("\n");
+    frame_add (&f, "\n");
     for (int i = 0; i < GRID_SIZE * GRID_SIZE * GRID_SIZE; i++)
     {
       int l = (i / (GRID_SIZE * SQUARE_SIZE)) / SQUARE_SIZE;
@@ -99,163 +320,165 @@ grid_print (uintptr_t id, sudoku_grid_event_args evt_args)
 
       if (i % (GRID_SIZE * SQUARE_SIZE * SQUARE_SIZE * SQUARE_SIZE) == 0)
       {
-        printf ("     +");
+        frame_add (&f, "     +");
         for (int i = 0; i < GRID_SIZE; i++)
         {
           for (int j = 0; j < SQUARE_SIZE; j++)
-            printf ("-");
-          printf ("+");
+            frame_add (&f, "-");
+          frame_add (&f, "+");
         }
-        printf ("\n");
+        frame_add (&f, "\n");
       }
       else if (i % (GRID_SIZE * SQUARE_SIZE * SQUARE_SIZE) == 0)
       {
-        printf ("     +");
+        frame_add (&f, "     +");
         for (int i = 0; i < GRID_SIZE; i++)
         {
           for (int j = 0; j < SQUARE_SIZE; j++)
-            printf (".");
-          printf ("+");
+            frame_add (&f, ".");
+          frame_add (&f, "+");
         }
-        printf ("\n");
+        frame_add (&f, "\n");
       }
 
       if ((i + (SQUARE_SIZE - 1) * GRID_SIZE * SQUARE_SIZE) % (SQUARE_SIZE * SQUARE_SIZE * SQUARE_SIZE * SQUARE_SIZE) ==
           0)
-        printf ("   %c |", sudoku_grid_referential.row_name[i / (GRID_SIZE * GRID_SIZE)]);
+        frame_add (&f, "   %c |", sudoku_grid_referential.row_name[i / (GRID_SIZE * GRID_SIZE)]);
       else if (i % (SQUARE_SIZE * SQUARE_SIZE * SQUARE_SIZE) == 0)
-        printf ("     |");
+        frame_add (&f, "     |");
 
       if (!ok[l][c])            // Display all candidates
       {
-        if (evt_args.grid[l][c][v - 1])
-          printf ("%c", sudoku_grid_referential.value_name[evt_args.grid[l][c][v - 1] - 1]);
+        if (sudoku_grid_view_candidates (view, l, c) & (1 << (v - 1)))
+          frame_add (&f, "%c", sudoku_grid_referential.value_name[v - 1]);
         else
-          printf (" ");
+          frame_add (&f, " ");
       }
       else                      // Display one single candidate
       {
         if (v == (GRID_SIZE + 1) / 2 - (GRID_SIZE % 2 ? 0 : SQUARE_SIZE / 2))
-          printf ("%c", sudoku_grid_referential.value_name[ok[l][c] - 1]);
+          frame_add (&f, "%c", sudoku_grid_referential.value_name[ok[l][c] - 1]);
         else
-          printf (" ");
+          frame_add (&f, " ");
       }
 
       if ((i + 1) % (GRID_SIZE * SQUARE_SIZE) == 0)
-        printf ("|\n");
+        frame_add (&f, "|\n");
       else if ((i + 1) % (SQUARE_SIZE * SQUARE_SIZE) == 0)
-        printf ("|");
+        frame_add (&f, "|");
       else if ((i + 1) % SQUARE_SIZE == 0)
-        printf (":");
+        frame_add (&f, ":");
     }
-    printf ("    +");
+    frame_add (&f, "    +");
     for (int i = 0; i < GRID_SIZE; i++)
     {
       for (int j = 0; j < SQUARE_SIZE; j++)
-        printf ("-");
-      printf ("+");
+        frame_add (&f, "-");
+      frame_add (&f, "+");
     }
-    printf ("\n");
-    printf ("\n");
+    frame_add (&f, "\n");
+    frame_add (&f, "\n");
+    frame_show (&f);
     askAgain = 1;
   }
   else if (d == NORMAL)
   {
-    nbCells = evt_args.nbCells;
-    printf ("Grid #%u:\n", (unsigned int) id);
-    printf ("[%3i]", evt_args.nbCells);
+    nbCells = viewNbCells;
+    frame_add (&f, "Grid #%u:\n", (unsigned int) id);
+    frame_add (&f, "[%3i]", viewNbCells);
     for (int i = 0; i < GRID_SIZE; i++)
-      printf (" %c", sudoku_grid_referential.column_name[i]);
-    printf ("\n");
+      frame_add (&f, " %c", sudoku_grid_referential.column_name[i]);
+    frame_add (&f, "\n");
     for (int l = 0; l < GRID_SIZE; l++)
     {
       if (l % SQUARE_SIZE == 0)
       {
-        printf ("     +");
+        frame_add (&f, "     +");
         for (int i = 0; i < SQUARE_SIZE; i++)
         {
           for (int j = 0; j < 2 * SQUARE_SIZE - 1; j++)
-            printf ("-");
-          printf ("+");
+            frame_add (&f, "-");
+          frame_add (&f, "+");
         }
-        printf ("\n");
+        frame_add (&f, "\n");
       }
-      printf ("   %c |", sudoku_grid_referential.row_name[l]);
+      frame_add (&f, "   %c |", sudoku_grid_referential.row_name[l]);
       for (int c = 1; c <= GRID_SIZE; c++)
       {
-        int val = 0;
+        int val = ok[l][c - 1];
 
-        for (int v = 1; v <= GRID_SIZE; v++)
-        {
-          if (evt_args.grid[l][c - 1][v - 1])
-          {
-            if (val)
-            {
-              v = GRID_SIZE;
-              val = 0;
-            }
-            else
-              val = evt_args.grid[l][c - 1][v - 1];
-          }
-        }
         if (val)
-          printf ("%c", sudoku_grid_referential.value_name[val - 1]);
+          frame_add (&f, "%c", sudoku_grid_referential.value_name[val - 1]);
         else
-          printf (".");
+          frame_add (&f, ".");
         if (c % SQUARE_SIZE == 0)
-          printf ("|");
+          frame_add (&f, "|");
         else
-          printf (" ");
+          frame_add (&f, " ");
       }
-      printf ("\n");
+      frame_add (&f, "\n");
     }
-    printf ("     +");
+    frame_add (&f, "     +");
     for (int i = 0; i < SQUARE_SIZE; i++)
     {
       for (int j = 0; j < 2 * SQUARE_SIZE - 1; j++)
-        printf ("-");
-      printf ("+");
+        frame_add (&f, "-");
+      frame_add (&f, "+");
     }
-    printf ("\n");
-    printf ("\n");
+    frame_add (&f, "\n");
+    frame_add (&f, "\n");
+    frame_show (&f);
     askAgain = 1;
   }
   else if (d == RULES)
   {
-    nbCells = evt_args.nbCells;
-    printf ("Grid #%u: [%2i] ", (unsigned int) id, evt_args.nbCells);
+    nbCells = viewNbCells;
+    frame_add (&f, "Grid #%u: [%2i] ", (unsigned int) id, viewNbCells);
     for (int l = 0; l < GRID_SIZE; l++)
     {
       for (int c = 0; c < GRID_SIZE; c++)
       {
-        int val = 0;
+        int val = ok[l][c];
 
-        for (int v = 1; v <= GRID_SIZE; v++)
-        {
-          if (evt_args.grid[l][c][v - 1])
-          {
-            if (val)
-            {
-              v = GRID_SIZE;
-              val = 0;
-            }
-            else
-              val = evt_args.grid[l][c][v - 1];
-          }
-        }
-        printf ("%c", val ? sudoku_grid_referential.value_name[val - 1] : '.');
+        frame_add (&f, "%c", val ? sudoku_grid_referential.value_name[val - 1] : '.');
       }
     }
-    printf ("\n");
+    frame_add (&f, "\n");
+    output_write (f.text, f.length);
     askAgain = 1;
   }
 }
 
+/// Event handler to display the changes of a grid, at a capped rate on a terminal unless in interactive mode.
+/// @param [in] id Grid identifier
+/// @param [in] view Grid to be displayed
+static void
+grid_print_change (uintptr_t id, const sudoku_grid_view * view)
+{
+  static long long last;
+
+  if (onTerminal && !interactive)
+  {
+    struct timespec t;
+
+    clock_gettime (CLOCK_MONOTONIC, &t);
+
+    long long now = t.tv_sec * 1000000000LL + t.tv_nsec;
+
+    if (now - last < FRAME_PERIOD)
+      return;
+    last = now;
+  }
+  grid_print (id, view);
+}
+
+static void terminal_end (void);
+
 /// Event handler for interactive mode.
 /// @param [in] id Grid identifier
-/// @param [in] evt_args Event to be processed
+/// @param [in] view Grid processed
 static void
-ask (uintptr_t id, sudoku_grid_event_args evt_args)
+ask (uintptr_t id, const sudoku_grid_view * view)
 {
   if (!askAgain)
     return;
@@ -273,8 +496,9 @@ ask (uintptr_t id, sudoku_grid_event_args evt_args)
       printf ("\nConfirm (y[es]/n[o])?[n]");
       if (tolower (getchar ()) == 'y')
       {
-        sudoku_grid_event_handler_remove (ON_CHANGE, ask);
-        terminal_unset ();
+        sudoku_grid_view_handler_remove (ON_CHANGE, ask);
+        terminal_end ();
+        interactive = 0;
       }
       printf ("\n");
       return;
@@ -392,8 +616,10 @@ void
 terminal_set (int iflag)
 {
   // set handlers
-  sudoku_grid_event_handler_add (ON_INIT | ON_SOLVED, grid_print);
+  sudoku_grid_view_handler_add (ON_INIT | ON_SOLVED, grid_print);
   sudoku_message_handler_add (print_message);
+  onTerminal = isatty (STDOUT_FILENO);
+  interactive = 0;
   if (iflag)
   {
     struct termios st;
@@ -405,21 +631,23 @@ terminal_set (int iflag)
     else
     {
       terminal_init ();
-      sudoku_grid_event_handler_add (ON_CHANGE, ask);
+      interactive = 1;
+      sudoku_grid_view_handler_add (ON_CHANGE, ask);
     }
   }
   else
   {
     terminal_end ();
-    sudoku_grid_event_handler_remove (ON_CHANGE, ask);
+    sudoku_grid_view_handler_remove (ON_CHANGE, ask);
   }
 }
 
-/// Reset terminal.
+/// Reset terminal, releasing the bottom of the screen from the grid drawn there.
 void
 terminal_unset (void)
 {
   terminal_end ();
+  frame_unpin ();
 }
 
 /// Get display mode.
@@ -437,11 +665,11 @@ display
 terminal_display_set (display d)
 {
   sudoku_message_handler_remove (print_message);
-  sudoku_grid_event_handler_remove (ON_CHANGE, grid_print);
+  sudoku_grid_view_handler_remove (ON_CHANGE, grid_print_change);
 
   sudoku_message_handler_add (print_message);
   if ((d & NORMAL) || (d & VERBOSE))
-    sudoku_grid_event_handler_add (ON_CHANGE, grid_print);
+    sudoku_grid_view_handler_add (ON_CHANGE, grid_print_change);
 
   printf ("Display mode :%s%s%s%s.\n", (d ? "" : " NONE"), (d & NORMAL ? " GRIDS" : ""),
           (d & VERBOSE ? " CANDIDATES" : ""), (d & RULES ? " RULES" : ""));